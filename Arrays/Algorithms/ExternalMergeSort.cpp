@@ -0,0 +1,405 @@
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Sort.h"
+using namespace std;
+using namespace std::chrono;
+typedef long long int lli;
+
+
+/*
+External (out of core) Merge Sort for files of raw native int32 values bigger than RAM.
+
+Phase 1 (run generation)
+    Input is mmap-ed read only and cut into runs that fit the memory budget. Worker threads
+    pull run numbers from a shared counter, copy their run into a private buffer, sort it with
+    the in-memory merge sort (Sorting::mergeSort from Sort.h) and write it to a temp file in
+    one sequential write.
+Phase 2 (k-way merge)
+    Runs are mmap-ed with MADV_SEQUENTIAL and merged with a loser tree, log2(k) comparisons
+    per element and only one leaf to root path replayed per output. Readers ask the kernel for
+    the next window ahead of time (MADV_WILLNEED) and drop consumed windows (MADV_DONTNEED).
+    Output goes through two big buffers, one is written by a background task while the merge
+    fills the other, so the merge CPU work hides behind the disk.
+    More than MAX_FAN_IN runs are merged in rounds.
+
+Both phases read & write every byte once sequentially so throughput is bounded by disk bandwidth.
+TC = O(nlog(n)) comparisons, 2 * (1 + merge rounds) sequential passes over the data.
+SC = O(memory budget)
+
+Compile: g++ -O3 -std=c++17 -pthread ExternalMergeSort.cpp
+Run    : ./a.out gen   <file> <count>                          Writes random ints.
+         ./a.out sort  <in> <out> [memory MB] [threads] [tmp dir]
+         ./a.out check <file>                                  Verifies ascending order.
+*/
+
+
+//Read only mapping of a whole file, unmapped by the destructor.
+class MappedFile
+{
+    private:
+        void *m_pAddr;
+        size_t m_iBytes;
+
+    public:
+    MappedFile() : m_pAddr{NULL}, m_iBytes{0} {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string& strPath, int iAdvice)
+    {
+        int fd = ::open(strPath.c_str(), O_RDONLY);
+        if (fd < 0) { perror(strPath.c_str()); return false; }
+        struct stat st;
+        fstat(fd, &st);
+        m_iBytes = st.st_size;
+        if (m_iBytes > 0)
+        {
+            m_pAddr = mmap(NULL, m_iBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED == m_pAddr) { perror("mmap"); m_pAddr = NULL; ::close(fd); return false; }
+            madvise(m_pAddr, m_iBytes, iAdvice);
+        }
+        ::close(fd);                                //Mapping stays valid.
+        return true;
+    }
+
+    void close()
+    {
+        if (m_pAddr) { munmap(m_pAddr, m_iBytes); m_pAddr = NULL; }
+    }
+    inline const int* data() const { return (const int*)m_pAddr; }
+    inline size_t count() const { return m_iBytes / sizeof(int); }
+    inline size_t bytes() const { return m_iBytes; }
+};
+
+
+/*
+Sequential reader over a mapped run with read-ahead.
+Every time the cursor crosses into a new window the following window is requested with
+MADV_WILLNEED and the finished one is released with MADV_DONTNEED, so page cache usage per
+run stays ~2 windows no matter how big the run is.
+*/
+class RunReader
+{
+    private:
+        static constexpr size_t WINDOW = 8 << 20;   //Bytes.
+        MappedFile m_file;
+        const int *m_pCur, *m_pEnd, *m_pNextWindow;
+
+        void advise(const int* pFrom, int iAdvice)
+        {
+            uintptr_t iBeg = (uintptr_t)pFrom & ~(uintptr_t)4095;
+            uintptr_t iEnd = min((uintptr_t)pFrom + WINDOW, (uintptr_t)m_pEnd);
+            if (iBeg < iEnd) madvise((void*)iBeg, iEnd - iBeg, iAdvice);
+        }
+
+    public:
+    RunReader() : m_pCur{NULL}, m_pEnd{NULL}, m_pNextWindow{NULL} {}
+
+    bool open(const string& strPath)
+    {
+        if (!m_file.open(strPath, MADV_SEQUENTIAL)) return false;
+        m_pCur = m_file.data();
+        m_pEnd = m_pCur + m_file.count();
+        m_pNextWindow = m_pCur;
+        return true;
+    }
+    inline bool empty() const { return m_pCur == m_pEnd; }
+    inline int peek() const { return *m_pCur; }
+    inline void next()
+    {
+        if (++m_pCur >= m_pNextWindow && m_pCur < m_pEnd)
+        {
+            if (m_pNextWindow != m_file.data()) advise(m_pNextWindow - WINDOW / sizeof(int), MADV_DONTNEED);
+            m_pNextWindow += WINDOW / sizeof(int);
+            advise(m_pNextWindow, MADV_WILLNEED);
+        }
+    }
+};
+
+
+/*
+Double buffered sequential writer. Full buffer is handed to a background write while the
+caller keeps filling the other one.
+*/
+class SeqWriter
+{
+    private:
+        int m_fd;
+        vector<int> m_vecBuf[2];
+        size_t m_iFill;
+        int m_iActive;
+        future<bool> m_pending;
+        bool m_bOk;
+
+        static bool writeAll(int fd, const char* pData, size_t iBytes)
+        {
+            while (iBytes > 0)
+            {
+                ssize_t iDone = ::write(fd, pData, iBytes);
+                if (iDone < 0) { if (EINTR == errno) continue; perror("write"); return false; }
+                pData += iDone; iBytes -= iDone;
+            }
+            return true;
+        }
+
+        void flush()
+        {
+            if (m_pending.valid()) m_bOk &= m_pending.get();
+            const int* pData = m_vecBuf[m_iActive].data();
+            size_t iBytes = m_iFill * sizeof(int);
+            int fd = m_fd;
+            m_pending = async(launch::async, [=]() { return writeAll(fd, (const char*)pData, iBytes); });
+            m_iActive ^= 1;
+            m_iFill = 0;
+        }
+
+    public:
+    explicit SeqWriter(size_t iBufInts) : m_fd{-1}, m_iFill{0}, m_iActive{0}, m_bOk{true}
+    {
+        m_vecBuf[0].resize(iBufInts);
+        m_vecBuf[1].resize(iBufInts);
+    }
+    SeqWriter(const SeqWriter&) = delete;
+    SeqWriter& operator=(const SeqWriter&) = delete;
+    ~SeqWriter() { close(); }
+
+    bool open(const string& strPath)
+    {
+        m_fd = ::open(strPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0) { perror(strPath.c_str()); return false; }
+        posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        return true;
+    }
+    inline void push(int iVal)
+    {
+        m_vecBuf[m_iActive][m_iFill] = iVal;
+        if (++m_iFill == m_vecBuf[m_iActive].size()) flush();
+    }
+    bool close()
+    {
+        if (m_fd < 0) return m_bOk;
+        if (m_iFill > 0) flush();
+        if (m_pending.valid()) m_bOk &= m_pending.get();
+        ::close(m_fd);
+        m_fd = -1;
+        return m_bOk;
+    }
+};
+
+
+/*
+Loser tree over k runs. Leaves are k..2k-1, internal node n keeps the loser of the match
+played there and m_vecTree[0] the overall winner. After the winner is popped only its
+leaf to root path is replayed, log2(k) comparisons, vs 2*log2(k) for a binary heap.
+Exhausted runs lose every match.
+*/
+class LoserTree
+{
+    private:
+        vector<RunReader>& m_vecRuns;
+        vector<int> m_vecTree;
+        int m_iK;
+
+        inline bool beats(int a, int b) const
+        {
+            if (m_vecRuns[a].empty()) return false;
+            if (m_vecRuns[b].empty()) return true;
+            return m_vecRuns[a].peek() < m_vecRuns[b].peek();
+        }
+
+    public:
+    explicit LoserTree(vector<RunReader>& vecRuns) : m_vecRuns(vecRuns), m_vecTree(vecRuns.size()), m_iK((int)vecRuns.size())
+    {
+        if (0 == m_iK) return;                      //Empty input, nothing to merge.
+        vector<int> vecWinner(2 * m_iK);
+        for (int i=0; i<m_iK; ++i) vecWinner[m_iK + i] = i;
+        for (int n=m_iK-1; n>=1; --n)
+        {
+            int l = vecWinner[2*n], r = vecWinner[2*n + 1];
+            if (beats(l, r)) { vecWinner[n] = l; m_vecTree[n] = r; }
+            else             { vecWinner[n] = r; m_vecTree[n] = l; }
+        }
+        m_vecTree[0] = vecWinner[1];
+    }
+
+    inline bool empty() const { return (0 == m_iK) || m_vecRuns[m_vecTree[0]].empty(); }
+
+    inline int pop()
+    {
+        int w = m_vecTree[0];
+        int iVal = m_vecRuns[w].peek();
+        m_vecRuns[w].next();
+        for (int n=(w + m_iK) >> 1; n>=1; n>>=1)
+        {
+            if (beats(m_vecTree[n], w)) swap(m_vecTree[n], w);
+        }
+        m_vecTree[0] = w;
+        return iVal;
+    }
+};
+
+
+class ExternalMergeSort
+{
+    private:
+        static constexpr size_t MAX_FAN_IN = 512;
+        static constexpr size_t WRITE_BUF_INTS = (4 << 20) / sizeof(int);
+
+        size_t m_iMemBytes;
+        int m_iThreads;
+        string m_strTmpDir;
+        atomic<int> m_iTmpSeq;
+
+        string tmpName()
+        {
+            return m_strTmpDir + "/extsort_" + to_string(getpid()) + "_" + to_string(m_iTmpSeq.fetch_add(1)) + ".run";
+        }
+
+        bool writeRun(const string& strPath, const int* pData, size_t iCnt)
+        {
+            int fd = ::open(strPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) { perror(strPath.c_str()); return false; }
+            const char* p = (const char*)pData;
+            size_t iBytes = iCnt * sizeof(int);
+            while (iBytes > 0)
+            {
+                ssize_t iDone = ::write(fd, p, iBytes);
+                if (iDone < 0) { if (EINTR == errno) continue; perror("write"); ::close(fd); return false; }
+                p += iDone; iBytes -= iDone;
+            }
+            ::close(fd);
+            return true;
+        }
+
+        /*
+        Memory budget split across threads, each needs its run + half a run for the merge buffer.
+        */
+        bool generateRuns(const string& strIn, vector<string>& vecRunFiles)
+        {
+            MappedFile input;
+            if (!input.open(strIn, MADV_SEQUENTIAL)) return false;
+            size_t n = input.count();
+            size_t iRunInts = max<size_t>(1 << 16, m_iMemBytes / m_iThreads / (sizeof(int) * 3 / 2));
+            size_t iRuns = (n + iRunInts - 1) / iRunInts;
+            vecRunFiles.resize(iRuns);
+
+            atomic<size_t> iNext{0};
+            atomic<bool> bOk{true};
+            vector<thread> vecWorkers;
+            for (int t=0; t<m_iThreads; ++t)
+            {
+                vecWorkers.emplace_back([&]() {
+                    vector<int> vecRun;
+                    for (size_t r = iNext.fetch_add(1); r < iRuns && bOk; r = iNext.fetch_add(1))
+                    {
+                        size_t iBeg = r * iRunInts, iEnd = min(n, iBeg + iRunInts);
+                        vecRun.assign(input.data() + iBeg, input.data() + iEnd);
+                        //Start is aligned down to its page, the length grows by the same amount.
+                        uintptr_t iOffset = (uintptr_t)(input.data() + iBeg);
+                        uintptr_t iAligned = iOffset & ~(uintptr_t)4095;
+                        madvise((void*)iAligned, (iEnd - iBeg) * sizeof(int) + (iOffset - iAligned), MADV_DONTNEED);
+                        Sorting::mergeSort(vecRun.begin(), vecRun.end());
+                        vecRunFiles[r] = tmpName();
+                        if (!writeRun(vecRunFiles[r], vecRun.data(), vecRun.size())) bOk = false;
+                    }
+                });
+            }
+            for (auto& t : vecWorkers) t.join();
+            return bOk;
+        }
+
+        bool mergeRuns(const vector<string>& vecRunFiles, const string& strOut)
+        {
+            vector<RunReader> vecRuns(vecRunFiles.size());
+            for (size_t i=0; i<vecRunFiles.size(); ++i)
+            {
+                if (!vecRuns[i].open(vecRunFiles[i])) return false;
+            }
+            SeqWriter writer(WRITE_BUF_INTS);
+            if (!writer.open(strOut)) return false;
+
+            LoserTree tree(vecRuns);
+            while (!tree.empty()) writer.push(tree.pop());
+            return writer.close();
+        }
+
+    public:
+    ExternalMergeSort(size_t iMemBytes, int iThreads, const string& strTmpDir) :
+        m_iMemBytes{iMemBytes}, m_iThreads{max(1, iThreads)}, m_strTmpDir{strTmpDir}, m_iTmpSeq{0} {}
+
+    bool sort(const string& strIn, const string& strOut)
+    {
+        vector<string> vecRunFiles;
+        bool bOk = generateRuns(strIn, vecRunFiles);
+
+        //Too many runs for one pass, merge groups of MAX_FAN_IN into bigger runs first.
+        while (bOk && vecRunFiles.size() > MAX_FAN_IN)
+        {
+            vector<string> vecNext;
+            size_t i = 0;
+            for (; i<vecRunFiles.size() && bOk; i+=MAX_FAN_IN)
+            {
+                vector<string> vecGroup(vecRunFiles.begin() + i, vecRunFiles.begin() + min(vecRunFiles.size(), i + MAX_FAN_IN));
+                vecNext.push_back(tmpName());
+                bOk = mergeRuns(vecGroup, vecNext.back());
+                for (auto& f : vecGroup) unlink(f.c_str());
+            }
+            for (; i<vecRunFiles.size(); ++i) unlink(vecRunFiles[i].c_str());   //Groups a failed merge never reached.
+            vecRunFiles.swap(vecNext);
+        }
+
+        if (bOk) bOk = mergeRuns(vecRunFiles, strOut);
+        for (auto& f : vecRunFiles)
+        {
+            if (!f.empty()) unlink(f.c_str());
+        }
+        return bOk;
+    }
+};
+
+
+int main(int argc, char** argv)
+{
+    string strMode = (argc > 1) ? argv[1] : "";
+    if ("gen" == strMode && argc > 3)
+    {
+        lli iCount = atoll(argv[3]);
+        SeqWriter writer((4 << 20) / sizeof(int));
+        if (!writer.open(argv[2])) return 1;
+        mt19937 rng(42);
+        for (lli i=0; i<iCount; ++i) writer.push((int)rng());
+        return writer.close() ? 0 : 1;
+    }
+    if ("check" == strMode && argc > 2)
+    {
+        MappedFile file;
+        if (!file.open(argv[2], MADV_SEQUENTIAL)) return 1;
+        bool bSorted = is_sorted(file.data(), file.data() + file.count());
+        cout << file.count() << " ints, " << (bSorted ? "sorted" : "NOT sorted") << endl;
+        return bSorted ? 0 : 1;
+    }
+    if ("sort" == strMode && argc > 3)
+    {
+        size_t iMemMB = (argc > 4) ? atoll(argv[4]) : 1024;
+        int iThreads = (argc > 5) ? atoi(argv[5]) : max(1u, thread::hardware_concurrency());
+        string strTmp = (argc > 6) ? argv[6] : (getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+
+        auto startTime = high_resolution_clock::now();
+        ExternalMergeSort sorter(iMemMB << 20, iThreads, strTmp);
+        bool bOk = sorter.sort(argv[2], argv[3]);
+        auto endTime = high_resolution_clock::now();
+        double dSec = duration_cast<microseconds>(endTime - startTime).count() / 1e6;
+
+        struct stat st;
+        double dMB = (0 == stat(argv[2], &st)) ? st.st_size / 1048576.0 : 0;
+        cout << (bOk ? "Sorted " : "FAILED ") << dMB << " MB in " << dSec << " s ("
+             << dMB / dSec << " MB/s)" << endl;
+        return bOk ? 0 : 1;
+    }
+    cout << "Usage: " << argv[0] << " gen <file> <count> | sort <in> <out> [memory MB] [threads] [tmp dir] | check <file>" << endl;
+    return 1;
+}
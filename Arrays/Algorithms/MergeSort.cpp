@@ -1,5 +1,5 @@
 //GFG = https://www.geeksforgeeks.org/problems/merge-sort/1
-#include <bits\stdc++.h>
+#include <bits/stdc++.h>
 using namespace std;
 
 
@@ -16,6 +16,8 @@ class Solution {
   
     void merge(vector<int>&arr, int iStart, int iMid, int iEnd)
     {
+        if (arr[iMid] <= arr[iMid+1]) return;   //Halves already in order, nothing to merge.
+
         int iSize = iEnd - iStart + 1, iLeft = iStart, iRight = iMid + 1;
         vector<int> i_arr(iSize, 0);
         
@@ -63,4 +65,222 @@ class Solution {
             merge(arr, l, iMid, r);
         }
     }
+
+  public:
+    static const int MIN_MERGE  = 32;   //Runs shorter than minRun are extended by insertion sort.
+    static const int MIN_GALLOP = 7;    //Wins in a row before merge switches to galloping.
+
+    /*
+    Adaptive (TimSort like) Merge Sort.
+    1> Input is scanned for natural runs, ascending (a[i] <= a[i+1]) or strictly descending
+       (reversed in place, strict keeps it stable). Short runs are extended to minRun with
+       binary insertion sort.
+    2> Runs are pushed on a stack and merged while the TimSort invariants are broken, so
+       merges stay balanced (lengths grow at least like fibonacci).
+    3> Before a merge, galloping trims the prefix of run1 & suffix of run2 that are already
+       in place, when nothing is left the merge is skipped entirely.
+    4> Merge starts one element at a time and switches to galloping (exponential search +
+       bulk copy) once one run wins MIN_GALLOP times in a row.
+    Sorted input is one run -> O(n). Reverse sorted input is one descending run -> O(n).
+    Random input is still O(nlog(n)).
+
+    TC = O(n) best, O(nlog(n)) worst
+    SC = O(N)
+    */
+    void adaptiveMergeSort(vector<int>& arr, int l, int r)
+    {
+        if (r - l < 1) return;
+        int iMinRun = minRunLength(r - l + 1);
+        vector<pair<int,int>> vec_Runs;         //(base, length)
+        vector<int> i_vecTmp;
+
+        int iLo = l;
+        while (iLo <= r)
+        {
+            int iRunLen = countRunAndMakeAscending(arr, iLo, r);
+            if (iRunLen < iMinRun)
+            {
+                int iForce = min(iMinRun, r - iLo + 1);
+                binaryInsertionSort(arr, iLo, iLo + iForce - 1, iLo + iRunLen);
+                iRunLen = iForce;
+            }
+            vec_Runs.push_back({iLo, iRunLen});
+            mergeCollapse(arr, vec_Runs, i_vecTmp);
+            iLo += iRunLen;
+        }
+
+        while (vec_Runs.size() > 1)
+        {
+            int n = vec_Runs.size() - 2;
+            if (n > 0 && vec_Runs[n-1].second < vec_Runs[n+1].second) --n;
+            mergeAt(arr, vec_Runs, n, i_vecTmp);
+        }
+    }
+
+    //Same as TimSort, n/2^k rounded up so n/minRun is a power of 2 or just below.
+    int minRunLength(int n)
+    {
+        int r = 0;
+        while (n >= MIN_MERGE)
+        {
+            r |= (n & 1);
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    //Length of the run starting at iLo, a descending run is reversed to ascending.
+    int countRunAndMakeAscending(vector<int>& arr, int iLo, int iHi)
+    {
+        int iRunHi = iLo + 1;
+        if (iRunHi > iHi) return 1;
+
+        if (arr[iRunHi] < arr[iLo])
+        {
+            while (iRunHi + 1 <= iHi && arr[iRunHi + 1] < arr[iRunHi]) ++iRunHi;
+            reverse(arr.begin() + iLo, arr.begin() + iRunHi + 1);
+        }
+        else
+        {
+            while (iRunHi + 1 <= iHi && arr[iRunHi + 1] >= arr[iRunHi]) ++iRunHi;
+        }
+        return iRunHi - iLo + 1;
+    }
+
+    //arr[iLo..iStart-1] is sorted, inserts arr[iStart..iHi] into it.
+    void binaryInsertionSort(vector<int>& arr, int iLo, int iHi, int iStart)
+    {
+        for (int i=iStart; i<=iHi; ++i)
+        {
+            int iPivot = arr[i];
+            auto itPos = upper_bound(arr.begin() + iLo, arr.begin() + i, iPivot);
+            move_backward(itPos, arr.begin() + i, arr.begin() + i + 1);
+            *itPos = iPivot;
+        }
+    }
+
+    /*
+    Keeps for the top runs A, B, C (C on top)...  |A| > |B| + |C|  and  |B| > |C|
+    checking one level deeper as well (the fix for the original TimSort invariant bug).
+    */
+    void mergeCollapse(vector<int>& arr, vector<pair<int,int>>& vec_Runs, vector<int>& i_vecTmp)
+    {
+        while (vec_Runs.size() > 1)
+        {
+            int n = vec_Runs.size() - 2;
+            if ((n > 0 && vec_Runs[n-1].second <= vec_Runs[n].second + vec_Runs[n+1].second) ||
+                (n > 1 && vec_Runs[n-2].second <= vec_Runs[n-1].second + vec_Runs[n].second))
+            {
+                if (vec_Runs[n-1].second < vec_Runs[n+1].second) --n;
+            }
+            else if (vec_Runs[n].second > vec_Runs[n+1].second)
+            {
+                break;
+            }
+            mergeAt(arr, vec_Runs, n, i_vecTmp);
+        }
+    }
+
+    //Merges stack runs n & n+1.
+    void mergeAt(vector<int>& arr, vector<pair<int,int>>& vec_Runs, int n, vector<int>& i_vecTmp)
+    {
+        int iBase1 = vec_Runs[n].first, iLen1 = vec_Runs[n].second;
+        int iBase2 = vec_Runs[n+1].first, iLen2 = vec_Runs[n+1].second;
+        vec_Runs[n].second = iLen1 + iLen2;
+        vec_Runs.erase(vec_Runs.begin() + n + 1);
+
+        //Elements of run1 <= first of run2 are already in place.
+        int k = gallopRight(arr[iBase2], arr, iBase1, iLen1);
+        iBase1 += k; iLen1 -= k;
+        if (0 == iLen1) return;
+
+        //Elements of run2 >= last of run1 are already in place.
+        iLen2 = gallopLeft(arr[iBase1 + iLen1 - 1], arr, iBase2, iLen2);
+        if (0 == iLen2) return;
+
+        mergeLo(arr, iBase1, iLen1, iBase2, iLen2, i_vecTmp);
+    }
+
+    /*
+    Merges adjacent runs arr[iBase1..+iLen1) & arr[iBase2..+iLen2), run1 is copied out and
+    the result is written from iBase1 forwards. The write position never passes the read
+    position of run2 so run2 is read in place.
+    */
+    void mergeLo(vector<int>& arr, int iBase1, int iLen1, int iBase2, int iLen2, vector<int>& i_vecTmp)
+    {
+        i_vecTmp.assign(arr.begin() + iBase1, arr.begin() + iBase1 + iLen1);
+        int iC1 = 0, iC2 = iBase2, iDest = iBase1, iEnd2 = iBase2 + iLen2;
+        int iMinGallop = MIN_GALLOP;
+
+        while (iC1 < iLen1 && iC2 < iEnd2)
+        {
+            int iCnt1 = 0, iCnt2 = 0;
+            while (iC1 < iLen1 && iC2 < iEnd2 && (iCnt1 | iCnt2) < iMinGallop)
+            {
+                if (arr[iC2] < i_vecTmp[iC1])
+                {
+                    arr[iDest++] = arr[iC2++];
+                    ++iCnt2; iCnt1 = 0;
+                }
+                else
+                {
+                    arr[iDest++] = i_vecTmp[iC1++];
+                    ++iCnt1; iCnt2 = 0;
+                }
+            }
+
+            while (iC1 < iLen1 && iC2 < iEnd2)
+            {
+                int k1 = gallopRight(arr[iC2], i_vecTmp, iC1, iLen1 - iC1);
+                copy(i_vecTmp.begin() + iC1, i_vecTmp.begin() + iC1 + k1, arr.begin() + iDest);
+                iDest += k1; iC1 += k1;
+                if (iC1 == iLen1) break;
+
+                int k2 = gallopLeft(i_vecTmp[iC1], arr, iC2, iEnd2 - iC2);
+                copy(arr.begin() + iC2, arr.begin() + iC2 + k2, arr.begin() + iDest);
+                iDest += k2; iC2 += k2;
+                if (iC2 == iEnd2) break;
+
+                if (k1 < MIN_GALLOP && k2 < MIN_GALLOP)
+                {
+                    ++iMinGallop;                   //Galloping does not pay off here, back off.
+                    break;
+                }
+                if (iMinGallop > 1) --iMinGallop;
+            }
+        }
+        copy(i_vecTmp.begin() + iC1, i_vecTmp.begin() + iLen1, arr.begin() + iDest);
+    }
+
+    /*
+    Galloping search, probes offsets 1, 3, 7, 15 .. then binary searches the last gap.
+    Finds a position k steps away in O(log(k)) instead of O(log(n)).
+    gallopRight = count of arr[iBase..+iLen) that are <= iKey.
+    gallopLeft  = count of arr[iBase..+iLen) that are <  iKey.
+    */
+    int gallopRight(int iKey, const vector<int>& arr, int iBase, int iLen)
+    {
+        int iOfs = 1, iLastOfs = 0;
+        while (iOfs < iLen && arr[iBase + iOfs - 1] <= iKey)
+        {
+            iLastOfs = iOfs;
+            iOfs = (iOfs << 1) + 1;
+            if (iOfs <= 0) iOfs = iLen;             //int overflow.
+        }
+        iOfs = min(iOfs, iLen);
+        return upper_bound(arr.begin() + iBase + iLastOfs, arr.begin() + iBase + iOfs, iKey) - (arr.begin() + iBase);
+    }
+
+    int gallopLeft(int iKey, const vector<int>& arr, int iBase, int iLen)
+    {
+        int iOfs = 1, iLastOfs = 0;
+        while (iOfs < iLen && arr[iBase + iOfs - 1] < iKey)
+        {
+            iLastOfs = iOfs;
+            iOfs = (iOfs << 1) + 1;
+            if (iOfs <= 0) iOfs = iLen;
+        }
+        iOfs = min(iOfs, iLen);
+        return lower_bound(arr.begin() + iBase + iLastOfs, arr.begin() + iBase + iOfs, iKey) - (arr.begin() + iBase);
+    }
 };
\ No newline at end of file
@@ -10,35 +10,91 @@ class Solution {
         while (arr[iRPtr] >  iPivot) --iRPtr;
     
     Solution provided
-        while (arr[iLPtr] <= iPivot && iLPtr <= high) ++iLPtr;
-        while (arr[iRPtr] >  iPivot && iRPtr >= low) --iRPtr;
+        while (iLPtr <= high && arr[iLPtr] <= iPivot) ++iLPtr;
+        while (iRPtr >= low && arr[iRPtr] >  iPivot) --iRPtr;
+    Bound check has to come first, with the other order arr[high+1] is still read once.
 
     Time Complexity = O(nlog(n))
-    Space Complexity = O(1) Without considering stack space.
+    Space Complexity = O(log(n)) Stack, recursion goes into the smaller side only.
     */
     void quickSort(vector<int>& arr, int low, int high) 
     {
-        if (low < high)
+        quickSort(arr, low, high, introDepth(high - low + 1));
+    }
+
+    /*
+    Introsort loop: after iDepth partitions without finishing a range it is heap sorted,
+    so inputs built against the pivot choice (m3-killer) stay O(nlog(n)) instead of O(n^2).
+    The smaller side is sorted recursively and the loop continues on the larger one, ranges
+    of SELECT_INSERTION_MAX or less are finished by insertion sort.
+    */
+    void quickSort(vector<int>& arr, int low, int high, int iDepth)
+    {
+        while (high - low + 1 > SELECT_INSERTION_MAX)
         {
-            int iPivot = partition(arr, low, high);
-            quickSort(arr, low, iPivot-1);
-            quickSort(arr, iPivot+1, high);
+            if (0 == iDepth--)
+            {
+                heapSort(arr, low, high);
+                return;
+            }
+
+            int iLeftEnd, iRightBeg, iPivotVal;
+            if (hasManyDuplicates(arr, low, high, iPivotVal))
+            {
+                int iLt, iGt;
+                partition3(arr, low, high, iPivotVal, iLt, iGt);
+                iLeftEnd = iLt - 1; iRightBeg = iGt + 1;    //Equal keys [iLt..iGt] are already in place.
+            }
+            else
+            {
+                int iPivot = (high - low + 1 >= BLOCK_PARTITION_MIN) ? blockPartition(arr, low, high)
+                                                                     : partition(arr, low, high);
+                iLeftEnd = iPivot - 1; iRightBeg = iPivot + 1;
+            }
+
+            if (iLeftEnd - low < high - iRightBeg)
+            {
+                quickSort(arr, low, iLeftEnd, iDepth);
+                low = iRightBeg;
+            }
+            else
+            {
+                quickSort(arr, iRightBeg, high, iDepth);
+                high = iLeftEnd;
+            }
         }
+        insertionSort(arr, low, high);
+    }
+
+    //2*log2(n) partitions before giving up on a range, same budget as nthElement & Sort.h.
+    int introDepth(int n)
+    {
+        int iDepth = 0;
+        for (; n > 1; n >>= 1) iDepth += 2;
+        return iDepth;
+    }
+
+    void heapSort(vector<int>& arr, int low, int high)
+    {
+        make_heap(arr.begin() + low, arr.begin() + high + 1);
+        sort_heap(arr.begin() + low, arr.begin() + high + 1);
     }
 
   public:
     /* Places all smaller elements to left of pivot and all greater elements to right of pivot.
        Think how above mentioned logic is achieved in this code that's core idea behind quicksort .
+       Pivot is median of 3 (moved to arr[low]), with arr[low] itself sorted input was O(n^2).
     */
     int partition(vector<int>& arr, int low, int high) 
     {
+        medianOf3ToLow(arr, low, high);
         int iPivot = arr[low];
         int iLPtr = low, iRPtr = high;
         
         while (iLPtr < iRPtr)
         {
-            while (arr[iLPtr] <= iPivot && iLPtr <= high) ++iLPtr;
-            while (arr[iRPtr] >  iPivot && iRPtr >= low) --iRPtr;
+            while (iLPtr <= high && arr[iLPtr] <= iPivot) ++iLPtr;
+            while (iRPtr >= low && arr[iRPtr] >  iPivot) --iRPtr;
             if (iLPtr < iRPtr)                  //!IMP
                 swap(arr[iLPtr], arr[iRPtr]);   //!IMP
         }
@@ -46,4 +102,502 @@ class Solution {
         
         return iRPtr;
     }
+
+  public:
+    static const int DUP_SAMPLE_MIN  = 128; //Below this size sampling costs more than it saves.
+    static const int DUP_SAMPLE_SIZE = 31;  //Odd so the sample has a real median.
+
+    /*
+    Takes DUP_SAMPLE_SIZE evenly spaced keys from arr[low..high], sorts that small sample
+    and counts how many keys repeat their neighbour. If a quarter or more repeat, the range
+    is duplicate heavy and the 2-way partition would keep recursing over equal keys.
+    Median of the sample is returned in iPivotVal so partition3 gets a decent pivot for free.
+
+    Time Complexity = O(1) (Fixed sample size.)
+    */
+    bool hasManyDuplicates(vector<int>& arr, int low, int high, int& iPivotVal)
+    {
+        int iSize = high - low + 1;
+        if (iSize < DUP_SAMPLE_MIN) return false;
+
+        int i_arrSample[DUP_SAMPLE_SIZE];
+        long long iStep = iSize / DUP_SAMPLE_SIZE;
+        for (int i=0; i<DUP_SAMPLE_SIZE; ++i)
+        {
+            i_arrSample[i] = arr[low + i*iStep];
+        }
+        sort(i_arrSample, i_arrSample + DUP_SAMPLE_SIZE);
+
+        int iDupCnt = 0;
+        for (int i=1; i<DUP_SAMPLE_SIZE; ++i)
+        {
+            if (i_arrSample[i] == i_arrSample[i-1]) ++iDupCnt;
+        }
+        iPivotVal = i_arrSample[DUP_SAMPLE_SIZE/2];
+        return (iDupCnt*4 >= DUP_SAMPLE_SIZE);
+    }
+
+    /*
+    Three way (Dutch national flag) partition around value iPivotVal.
+    After the call...
+        arr[low  .. iLt-1] <  iPivotVal
+        arr[iLt  .. iGt  ] == iPivotVal
+        arr[iGt+1.. high ] >  iPivotVal
+    All keys equal to the pivot land in the middle block in one pass and are never
+    touched again, so an array of k distinct keys sorts in O(n*log(k)) instead of
+    degrading towards O(n^2).
+    iPivotVal must be present in arr[low..high] else the middle block is empty.
+
+    Time Complexity = O(n)
+    Space Complexity = O(1)
+    */
+    void partition3(vector<int>& arr, int low, int high, int iPivotVal, int& iLt, int& iGt)
+    {
+        int iIdx = low;
+        iLt = low; iGt = high;
+
+        while (iIdx <= iGt)
+        {
+            if (arr[iIdx] < iPivotVal)
+            {
+                swap(arr[iLt], arr[iIdx]);
+                ++iLt; ++iIdx;
+            }
+            else if (arr[iIdx] > iPivotVal)
+            {
+                swap(arr[iIdx], arr[iGt]);  //Element coming from right is unseen so iIdx stays.
+                --iGt;
+            }
+            else
+            {
+                ++iIdx;
+            }
+        }
+    }
+
+  public:
+    static const int BLOCK_SIZE = 64;                       //Offsets fit in unsigned char.
+    static const int BLOCK_PARTITION_MIN = 4 * BLOCK_SIZE;
+
+    /*
+    Block partition (BlockQuicksort / pdqsort style).
+    The classic loops above take one unpredictable branch per element, on random data half
+    of them mispredict. Here comparisons only produce offsets...
+        i_arrOffL[iNumL] = i;  iNumL += (arr[iL + i] >= iPivot);
+    that is a setcc + add, no branch. Once both sides hold offsets of misplaced elements
+    they are swapped in one batch, the only branches left are the loop counters.
+    Left side ends up < pivot, right side >= pivot (equal keys are handled by partition3).
+    Pivot is median of 3 so sorted / reversed input does not hit the O(n^2) case.
+
+    Time Complexity = O(n)
+    Space Complexity = O(BLOCK_SIZE)
+    */
+    int blockPartition(vector<int>& arr, int low, int high)
+    {
+        medianOf3ToLow(arr, low, high);
+        int iPivot = arr[low];
+        int iSplit = blockPartitionByValue(arr, low + 1, high, iPivot);
+        swap(arr[low], arr[iSplit - 1]);            //!IMP
+        return iSplit - 1;
+    }
+
+    //Moves median of arr[low], arr[mid], arr[high] to arr[low].
+    void medianOf3ToLow(vector<int>& arr, int low, int high)
+    {
+        int iMid = low + (high - low) / 2;
+        if (arr[iMid]  < arr[low]) swap(arr[iMid], arr[low]);
+        if (arr[high]  < arr[low]) swap(arr[high], arr[low]);
+        if (arr[high]  < arr[iMid]) swap(arr[high], arr[iMid]);
+        swap(arr[low], arr[iMid]);
+    }
+
+    /*
+    Core of blockPartition without pivot handling, arr[iL..iR] is split around value iPivot.
+    Returns first index of the >= part, i.e. arr[iL..ret-1] < iPivot <= arr[ret..iR].
+    Empty range (iR < iL) is fine and returns iL.
+    */
+    int blockPartitionByValue(vector<int>& arr, int iL, int iR, int iPivot)
+    {
+        unsigned char i_arrOffL[BLOCK_SIZE], i_arrOffR[BLOCK_SIZE];
+        int iNumL = 0, iNumR = 0, iStartL = 0, iStartR = 0;
+
+        while (iR - iL + 1 > 2 * BLOCK_SIZE)
+        {
+            if (0 == iNumL)
+            {
+                iStartL = 0;
+                for (int i=0; i<BLOCK_SIZE; ++i)
+                {
+                    i_arrOffL[iNumL] = (unsigned char)i;
+                    iNumL += (arr[iL + i] >= iPivot);
+                }
+            }
+            if (0 == iNumR)
+            {
+                iStartR = 0;
+                for (int i=0; i<BLOCK_SIZE; ++i)
+                {
+                    i_arrOffR[iNumR] = (unsigned char)i;
+                    iNumR += (arr[iR - i] < iPivot);
+                }
+            }
+
+            int iNum = min(iNumL, iNumR);
+            for (int i=0; i<iNum; ++i)
+            {
+                swap(arr[iL + i_arrOffL[iStartL + i]], arr[iR - i_arrOffR[iStartR + i]]);
+            }
+            iNumL -= iNum; iNumR -= iNum;
+            iStartL += iNum; iStartR += iNum;
+
+            if (0 == iNumL) iL += BLOCK_SIZE;       //Whole left block is now < pivot.
+            if (0 == iNumR) iR -= BLOCK_SIZE;       //Whole right block is now >= pivot.
+        }
+
+        /*
+        A block with leftover offsets was not consumed so it is still inside [iL..iR],
+        offsets are simply dropped and the classic scan finishes at most 3 blocks.
+        */
+        while (true)
+        {
+            while (iL <= iR && arr[iL] <  iPivot) ++iL;
+            while (iL <= iR && arr[iR] >= iPivot) --iR;
+            if (iL > iR) break;
+            swap(arr[iL], arr[iR]);
+            ++iL; --iR;
+        }
+        return iL;
+    }
+
+  public:
+    static const int PARALLEL_TASK_MIN = 1 << 15;       //Smaller ranges are not worth a thread.
+    static const int PARALLEL_PARTITION_MIN = 1 << 21;  //Top levels only, below this 1 thread partitions fast enough.
+
+    /*
+    Parallel in place quick sort.
+    Both sides of a partition above PARALLEL_TASK_MIN are sorted concurrently, one side on
+    a new thread and the other on the current one. Thread count is bounded by a shared
+    budget (iFreeThreads) so deep recursion never spawns more than iThreads threads, when
+    the budget is empty the side simply runs inline. Top level ranges (>= PARALLEL_PARTITION_MIN)
+    are also partitioned in parallel, see parallelPartition.
+    Every task carries the introsort depth budget of quickSort, a range that used it up is
+    heap sorted on its thread and small ranges go to the bounded quickSort, so recursion
+    depth stays under 2*log2(n) and bad pivots cost O(nlog(n)) at worst.
+
+    Time Complexity = O(nlog(n)/p) for p threads.
+    Space Complexity = O(1) Without considering stack space & per thread bookkeeping.
+    */
+    void parallelQuickSort(vector<int>& arr, int low, int high, int iThreads = 0)
+    {
+        if (iThreads <= 0) iThreads = max(1u, thread::hardware_concurrency());
+        atomic<int> iFreeThreads{iThreads - 1};
+        parallelQuickSort(arr, low, high, iFreeThreads, introDepth(high - low + 1));
+    }
+
+    void parallelQuickSort(vector<int>& arr, int low, int high, atomic<int>& iFreeThreads, int iDepth)
+    {
+        if (high - low + 1 < PARALLEL_TASK_MIN)
+        {
+            quickSort(arr, low, high, iDepth);
+            return;
+        }
+        if (0 == iDepth--)
+        {
+            heapSort(arr, low, high);
+            return;
+        }
+
+        int iLeftEnd, iRightBeg, iPivotVal;
+        if (hasManyDuplicates(arr, low, high, iPivotVal))
+        {
+            int iLt, iGt;
+            partition3(arr, low, high, iPivotVal, iLt, iGt);
+            iLeftEnd = iLt - 1; iRightBeg = iGt + 1;
+        }
+        else
+        {
+            int iPivot;
+            int iHelpers = (high - low + 1 >= PARALLEL_PARTITION_MIN) ? acquireThreads(iFreeThreads, INT_MAX) : 0;
+            if (iHelpers > 0)
+            {
+                iPivot = parallelPartition(arr, low, high, iHelpers + 1);
+                iFreeThreads.fetch_add(iHelpers);
+            }
+            else
+            {
+                iPivot = blockPartition(arr, low, high);
+            }
+            iLeftEnd = iPivot - 1; iRightBeg = iPivot + 1;
+        }
+
+        if (acquireThreads(iFreeThreads, 1))
+        {
+            thread tLeft([&]() {
+                parallelQuickSort(arr, low, iLeftEnd, iFreeThreads, iDepth);
+                iFreeThreads.fetch_add(1);
+            });
+            parallelQuickSort(arr, iRightBeg, high, iFreeThreads, iDepth);
+            tLeft.join();
+        }
+        else
+        {
+            parallelQuickSort(arr, low, iLeftEnd, iFreeThreads, iDepth);
+            parallelQuickSort(arr, iRightBeg, high, iFreeThreads, iDepth);
+        }
+    }
+
+    //Takes up to iWant threads out of the shared budget, returns how many it got.
+    int acquireThreads(atomic<int>& iFreeThreads, int iWant)
+    {
+        int iFree = iFreeThreads.load();
+        while (iFree > 0)
+        {
+            int iTake = min(iFree, iWant);
+            if (iFreeThreads.compare_exchange_weak(iFree, iFree - iTake)) return iTake;
+        }
+        return 0;
+    }
+
+    /*
+    Parallel partition with a fix-up pass.
+    1> Pivot (median of 3) is parked at arr[low], arr[low+1..high] is cut in iThreads chunks
+       and every chunk is block partitioned on its own thread -> [ < | >= ] per chunk.
+    2> Total count of < elements (iLess) gives the final split position iMidPos. Every >= element
+       left of iMidPos has to trade places with a < element right of it, both sides have the
+       same number of misplaced elements (iMisplaced).
+    3> Misplaced elements are described as interval lists, work [0..iMisplaced) is divided
+       evenly and each thread swaps its k-th left element with the k-th right one.
+    No element is moved more than twice.
+
+    Time Complexity = O(n/p + p*log(p))
+    Space Complexity = O(p)
+    */
+    int parallelPartition(vector<int>& arr, int low, int high, int iThreads)
+    {
+        medianOf3ToLow(arr, low, high);
+        int iPivot = arr[low];
+        int iBeg = low + 1;
+        long long iN = high - iBeg + 1;
+
+        vector<int> i_vecChunk(iThreads + 1), i_vecSplit(iThreads);
+        for (int c=0; c<=iThreads; ++c)
+        {
+            i_vecChunk[c] = iBeg + (int)(iN * c / iThreads);
+        }
+
+        runOnThreads(iThreads, [&](int c) {
+            i_vecSplit[c] = blockPartitionByValue(arr, i_vecChunk[c], i_vecChunk[c+1] - 1, iPivot);
+        });
+
+        long long iLess = 0;
+        for (int c=0; c<iThreads; ++c)
+        {
+            iLess += i_vecSplit[c] - i_vecChunk[c];
+        }
+        int iMidPos = iBeg + (int)iLess;
+
+        //Half open intervals of misplaced elements, left = >= before iMidPos, right = < from iMidPos on.
+        vector<pair<int,int>> vec_Left, vec_Right;
+        for (int c=0; c<iThreads; ++c)
+        {
+            int iGeBeg = i_vecSplit[c], iGeEnd = min(i_vecChunk[c+1], iMidPos);
+            if (iGeBeg < iGeEnd) vec_Left.push_back({iGeBeg, iGeEnd});
+
+            int iLtBeg = max(i_vecChunk[c], iMidPos), iLtEnd = i_vecSplit[c];
+            if (iLtBeg < iLtEnd) vec_Right.push_back({iLtBeg, iLtEnd});
+        }
+
+        vector<long long> i_vecLeftSum(1, 0), i_vecRightSum(1, 0);
+        for (auto& p : vec_Left)  i_vecLeftSum.push_back(i_vecLeftSum.back() + (p.second - p.first));
+        for (auto& p : vec_Right) i_vecRightSum.push_back(i_vecRightSum.back() + (p.second - p.first));
+        long long iMisplaced = i_vecLeftSum.back();
+
+        runOnThreads(iThreads, [&](int t) {
+            long long k    = iMisplaced * t / iThreads;
+            long long kEnd = iMisplaced * (t + 1) / iThreads;
+            if (k >= kEnd) return;
+
+            //Locate k-th misplaced element on both sides.
+            size_t iLI = upper_bound(i_vecLeftSum.begin(), i_vecLeftSum.end(), k) - i_vecLeftSum.begin() - 1;
+            size_t iRI = upper_bound(i_vecRightSum.begin(), i_vecRightSum.end(), k) - i_vecRightSum.begin() - 1;
+            int iLPos = vec_Left[iLI].first + (int)(k - i_vecLeftSum[iLI]);
+            int iRPos = vec_Right[iRI].first + (int)(k - i_vecRightSum[iRI]);
+
+            for (; k < kEnd; ++k)
+            {
+                if (iLPos == vec_Left[iLI].second)  iLPos = vec_Left[++iLI].first;
+                if (iRPos == vec_Right[iRI].second) iRPos = vec_Right[++iRI].first;
+                swap(arr[iLPos], arr[iRPos]);
+                ++iLPos; ++iRPos;
+            }
+        });
+
+        swap(arr[low], arr[iMidPos - 1]);           //!IMP
+        return iMidPos - 1;
+    }
+
+    //Runs fn(0..iThreads-1), index 0 on the calling thread.
+    template <typename Fn>
+    void runOnThreads(int iThreads, Fn fn)
+    {
+        vector<thread> vec_Threads;
+        for (int i=1; i<iThreads; ++i)
+        {
+            vec_Threads.emplace_back(fn, i);
+        }
+        fn(0);
+        for (auto& t : vec_Threads) t.join();
+    }
+
+  public:
+    static const int SELECT_INSERTION_MAX = 16;
+
+    /*
+    Introselect (nth_element). After the call arr[k] holds the value it would have in the
+    sorted array, arr[low..k-1] <= arr[k] <= arr[k+1..high].
+    Quickselect loop over the same partitions as quickSort, only the side holding k is kept,
+    n + n/2 + n/4 .. = O(n) on average. partition3 is used for duplicate heavy ranges, k
+    landing anywhere in the equal block ends the search.
+    Worst case protection, after 2*log2(n) rounds without finishing the pivot comes from
+    median of medians, which guarantees a 30/70 split, so the worst case stays O(n).
+
+    Time Complexity = O(n)
+    Space Complexity = O(1) (median of medians recursion is on n/5 elements.)
+    */
+    void nthElement(vector<int>& arr, int low, int high, int k)
+    {
+        int iBudget = introDepth(high - low + 1);
+
+        while (high - low + 1 > SELECT_INSERTION_MAX)
+        {
+            int iPivotVal, iLt, iGt;
+            if (iBudget-- <= 0)
+            {
+                iPivotVal = medianOfMedians(arr, low, high);
+                partition3(arr, low, high, iPivotVal, iLt, iGt);
+            }
+            else if (hasManyDuplicates(arr, low, high, iPivotVal))
+            {
+                partition3(arr, low, high, iPivotVal, iLt, iGt);
+            }
+            else
+            {
+                iLt = iGt = (high - low + 1 >= BLOCK_PARTITION_MIN) ? blockPartition(arr, low, high)
+                                                                    : partition(arr, low, high);
+            }
+
+            if (k < iLt)      high = iLt - 1;
+            else if (k > iGt) low = iGt + 1;
+            else return;                            //k is inside the pivot block.
+        }
+        insertionSort(arr, low, high);
+    }
+
+    /*
+    Groups of 5 are sorted, their medians moved to the front and the median of those
+    is selected recursively. Returns the pivot value.
+    */
+    int medianOfMedians(vector<int>& arr, int low, int high)
+    {
+        int iMedians = 0;
+        for (int i=low; i<=high; i+=5)
+        {
+            int iEnd = min(i + 4, high);
+            insertionSort(arr, i, iEnd);
+            swap(arr[low + iMedians], arr[i + (iEnd - i) / 2]);
+            ++iMedians;
+        }
+        int iMid = low + (iMedians - 1) / 2;
+        nthElement(arr, low, low + iMedians - 1, iMid);
+        return arr[iMid];
+    }
+
+    void insertionSort(vector<int>& arr, int low, int high)
+    {
+        for (int i=low+1; i<=high; ++i)
+        {
+            int iVal = arr[i], j = i - 1;
+            while (j >= low && arr[j] > iVal)
+            {
+                arr[j+1] = arr[j];
+                --j;
+            }
+            arr[j+1] = iVal;
+        }
+    }
+
+    /*
+    Smallest k elements of arr[low..high] in sorted order at arr[low..low+k-1], rest unordered.
+    Time Complexity = O(n + klog(k))
+    */
+    void partialSort(vector<int>& arr, int low, int high, int k)
+    {
+        if (k <= 0) return;
+        int iLast = low + min(k, high - low + 1) - 1;
+        nthElement(arr, low, high, iLast);
+        quickSort(arr, low, iLast);
+    }
+
+    /*
+    k largest values, largest first. arr is reordered (largest k end up at the back).
+    Time Complexity = O(n + klog(k))
+    */
+    vector<int> topK(vector<int>& arr, int k)
+    {
+        int n = arr.size();
+        k = max(0, min(k, n));
+        if (0 == k) return {};
+        nthElement(arr, 0, n - 1, n - k);
+        quickSort(arr, n - k, n - 1);
+        return vector<int>(arr.rbegin(), arr.rbegin() + k);
+    }
+};
+
+
+/*
+Streaming top-k for input that arrives in chunks and never sits in memory at once.
+Min heap of size k holds the best k seen so far, its top is the admission threshold.
+Once the heap is full almost every element fails the single compare against the top
+and costs O(1), only the (few) admitted ones pay O(log(k)).
+
+Time Complexity = O(n + m*log(k)), m = elements admitted (~k*log(n/k) for random order).
+Space Complexity = O(k)
+*/
+class StreamingTopK
+{
+    private:
+        size_t m_iK;
+        vector<int> m_vecHeap;                      //Min heap via greater<int>.
+
+    public:
+    StreamingTopK() = delete;
+    explicit StreamingTopK(size_t iK) : m_iK{iK} { m_vecHeap.reserve(iK); }
+
+    inline void push(int iVal)
+    {
+        if (m_vecHeap.size() < m_iK)
+        {
+            m_vecHeap.push_back(iVal);
+            push_heap(m_vecHeap.begin(), m_vecHeap.end(), greater<int>());
+        }
+        else if (m_iK > 0 && iVal > m_vecHeap.front())
+        {
+            pop_heap(m_vecHeap.begin(), m_vecHeap.end(), greater<int>());
+            m_vecHeap.back() = iVal;
+            push_heap(m_vecHeap.begin(), m_vecHeap.end(), greater<int>());
+        }
+    }
+
+    void push(const vector<int>& vecChunk)
+    {
+        for (int iVal : vecChunk) push(iVal);
+    }
+
+    //Current top k, largest first.
+    vector<int> result() const
+    {
+        vector<int> vecTop = m_vecHeap;
+        sort(vecTop.begin(), vecTop.end(), greater<int>());
+        return vecTop;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include <bits/stdc++.h>
+using namespace std;
+
+
+/*
+Radix Sort for integer keys (int / long long), no comparisons at all.
+LSD = least significant digit first, one stable counting pass per digit.
+MSD = most significant digit first, used by parallelRadixSort to cut the input in
+      256 independent buckets that threads sort with LSD.
+TC = O(n * passes), passes = 4 for 32 bit keys (8 bit digits), 6 for 64 bit keys (11 bit digits)
+SC = O(N)
+*/
+
+
+typedef long long int lli;
+class Solution {
+  public:
+    static const int RADIX_MIN = 64;                    //Below this std::sort wins.
+    static const int PARALLEL_RADIX_MIN = 1 << 20;
+    static const int MSD_BITS = 8;
+
+    void radixSort(vector<int>& arr) { lsdRadixSort(arr); }
+    void radixSort(vector<lli>& arr) { lsdRadixSort(arr); }
+    void parallelRadixSort(vector<int>& arr, int iThreads = 0) { msdRadixSort(arr, iThreads); }
+    void parallelRadixSort(vector<lli>& arr, int iThreads = 0) { msdRadixSort(arr, iThreads); }
+
+    /*
+    8 bit digits keep the 256 counters + write combining buffers of a pass in L1 for int.
+    For 64 bit keys 8 bit digits need 8 passes, 11 bit digits need 6 and 2048 counters still fit L2.
+    */
+    template <typename T>
+    static constexpr int digitBits() { return (sizeof(T) <= 4) ? 8 : 11; }
+
+    /*
+    Signed keys are mapped to unsigned by flipping the sign bit, that keeps the order
+    (INT_MIN -> 0, -1 -> 0x7FFFFFFF, 0 -> 0x80000000) so negative keys come first.
+    */
+    template <typename T>
+    static typename make_unsigned<T>::type toKey(T iVal)
+    {
+        typedef typename make_unsigned<T>::type U;
+        return (U)iVal ^ ((U)1 << (sizeof(T) * 8 - 1));
+    }
+
+    template <typename T>
+    void lsdRadixSort(vector<T>& arr)
+    {
+        if (arr.size() < RADIX_MIN)
+        {
+            sort(arr.begin(), arr.end());
+            return;
+        }
+        vector<T> vecTmp(arr.size());
+        T* pSorted = lsdPasses(arr.data(), vecTmp.data(), arr.size(), sizeof(T) * 8);
+        if (pSorted != arr.data())
+        {
+            memcpy(arr.data(), pSorted, arr.size() * sizeof(T));
+        }
+    }
+
+    /*
+    Sorts pSrc[0..n) on the low iKeyBits bits of the key using pTmp as scratch.
+    Histograms of all digits are built in one read of the input. A pass whose digit is
+    the same for every element (histogram has one bucket == n) would only copy, so it is
+    skipped, common for small valued or narrow range keys.
+    Data ping pongs between pSrc & pTmp, returns whichever one holds the sorted result.
+    */
+    template <typename T>
+    T* lsdPasses(T* pSrc, T* pTmp, size_t n, int iKeyBits)
+    {
+        const int D = digitBits<T>();
+        const size_t iBuckets = (size_t)1 << D;
+        const int iPasses = (iKeyBits + D - 1) / D;
+
+        vector<size_t> vecHist(iPasses * iBuckets, 0);
+        for (size_t i=0; i<n; ++i)
+        {
+            auto uKey = toKey(pSrc[i]);
+            for (int p=0; p<iPasses; ++p)
+            {
+                ++vecHist[p * iBuckets + ((uKey >> (p * D)) & (iBuckets - 1))];
+            }
+        }
+
+        vector<WCLine<T>> vecWCBuf(iBuckets);
+        for (int p=0; p<iPasses; ++p)
+        {
+            size_t* pHist = &vecHist[p * iBuckets];
+            if (pHist[(toKey(pSrc[0]) >> (p * D)) & (iBuckets - 1)] == n) continue;
+
+            size_t iSum = 0;
+            for (size_t b=0; b<iBuckets; ++b)
+            {
+                size_t iCnt = pHist[b];
+                pHist[b] = iSum;                    //Histogram turns into start offsets.
+                iSum += iCnt;
+            }
+            scatter(pSrc, pTmp, n, p * D, D, pHist, vecWCBuf.data());
+            swap(pSrc, pTmp);
+        }
+        return pSrc;
+    }
+
+    //Elements per 64 byte line of a write combining buffer.
+    template <typename T>
+    static constexpr int wcLine() { return 64 / sizeof(T); }
+
+    //One bucket's staging line, aligned like a cache line so a flush reads exactly one line.
+    template <typename T>
+    struct alignas(64) WCLine { T m_arr[wcLine<T>()]; };
+
+    /*
+    Stable scatter of pSrc into pDst by digit (iShift, iDigitBits), pOffset[digit] = next slot.
+    Direct scatter writes touch 256-2048 different lines in random order, each write is a
+    read-for-ownership miss. With software write combining every bucket first fills a
+    64 byte line in pWCBuf (stays in L1) and only full lines are copied out.
+    A bucket starts anywhere inside a destination line, so its staging line mirrors that
+    line: filling starts at the bucket's offset within it (vecHead) and the first flush
+    copies only the head up to the line boundary. Every later flush is one whole, aligned
+    destination line. pDst must be aligned to sizeof(T) (any vector is).
+    */
+    template <typename T>
+    void scatter(const T* pSrc, T* pDst, size_t n, int iShift, int iDigitBits, size_t* pOffset, WCLine<T>* pWCBuf)
+    {
+        const int WC = wcLine<T>();
+        const size_t iBuckets = (size_t)1 << iDigitBits;
+        vector<unsigned char> vecFill(iBuckets), vecHead(iBuckets);
+        for (size_t d=0; d<iBuckets; ++d)
+        {
+            vecHead[d] = vecFill[d] = (unsigned char)(((uintptr_t)(pDst + pOffset[d]) & 63) / sizeof(T));
+        }
+
+        for (size_t i=0; i<n; ++i)
+        {
+            size_t d = (toKey(pSrc[i]) >> iShift) & (iBuckets - 1);
+            T* pLine = pWCBuf[d].m_arr;
+            pLine[vecFill[d]] = pSrc[i];
+            if (++vecFill[d] == WC)
+            {
+                int iHead = vecHead[d];
+                memcpy(pDst + pOffset[d], pLine + iHead, (WC - iHead) * sizeof(T));
+                pOffset[d] += WC - iHead;
+                vecFill[d] = vecHead[d] = 0;
+            }
+        }
+        for (size_t d=0; d<iBuckets; ++d)
+        {
+            int iHead = vecHead[d], iCnt = vecFill[d] - iHead;
+            memcpy(pDst + pOffset[d], pWCBuf[d].m_arr + iHead, iCnt * sizeof(T));
+            pOffset[d] += iCnt;
+        }
+    }
+
+    /*
+    Parallel MSD Radix Sort for very large arrays.
+    1> Every thread builds a histogram of the top MSD_BITS of its chunk.
+    2> Per thread per bucket offsets are prefix summed so each thread owns disjoint
+       slots of every bucket and scatters its chunk into vecTmp without any sync.
+    3> The 256 buckets are now independent, threads pull them from a shared counter
+       (largest first for load balance) and finish each with LSD on the remaining bits.
+
+    Time Complexity = O(n * passes / p)
+    Space Complexity = O(N)
+    */
+    template <typename T>
+    void msdRadixSort(vector<T>& arr, int iThreads)
+    {
+        if (iThreads <= 0) iThreads = max(1u, thread::hardware_concurrency());
+        size_t n = arr.size();
+        if (n < PARALLEL_RADIX_MIN || 1 == iThreads)
+        {
+            lsdRadixSort(arr);
+            return;
+        }
+
+        const int iShift = sizeof(T) * 8 - MSD_BITS;
+        const size_t iBuckets = (size_t)1 << MSD_BITS;
+        vector<T> vecTmp(n);
+        vector<size_t> vecChunk(iThreads + 1);
+        for (int t=0; t<=iThreads; ++t) vecChunk[t] = n * t / iThreads;
+
+        vector<vector<size_t>> vecHist(iThreads, vector<size_t>(iBuckets, 0));
+        runOnThreads(iThreads, [&](int t) {
+            for (size_t i=vecChunk[t]; i<vecChunk[t+1]; ++i)
+            {
+                ++vecHist[t][toKey(arr[i]) >> iShift];
+            }
+        });
+
+        vector<size_t> vecBucketBeg(iBuckets + 1, 0);
+        size_t iSum = 0;
+        for (size_t b=0; b<iBuckets; ++b)
+        {
+            vecBucketBeg[b] = iSum;
+            for (int t=0; t<iThreads; ++t)
+            {
+                size_t iCnt = vecHist[t][b];
+                vecHist[t][b] = iSum;
+                iSum += iCnt;
+            }
+        }
+        vecBucketBeg[iBuckets] = n;
+
+        runOnThreads(iThreads, [&](int t) {
+            vector<WCLine<T>> vecWCBuf(iBuckets);
+            scatter(arr.data() + vecChunk[t], vecTmp.data(), vecChunk[t+1] - vecChunk[t],
+                    iShift, MSD_BITS, vecHist[t].data(), vecWCBuf.data());
+        });
+
+        vector<int> vecOrder(iBuckets);
+        iota(vecOrder.begin(), vecOrder.end(), 0);
+        sort(vecOrder.begin(), vecOrder.end(), [&](int a, int b) {
+            return (vecBucketBeg[a+1] - vecBucketBeg[a]) > (vecBucketBeg[b+1] - vecBucketBeg[b]);
+        });
+
+        atomic<size_t> iNext{0};
+        runOnThreads(iThreads, [&](int) {
+            for (size_t k = iNext.fetch_add(1); k < iBuckets; k = iNext.fetch_add(1))
+            {
+                size_t iBeg = vecBucketBeg[vecOrder[k]], iLen = vecBucketBeg[vecOrder[k] + 1] - iBeg;
+                if (0 == iLen) break;               //Ordered by size, rest are empty too.
+                T* pSorted;
+                if (iLen < RADIX_MIN)
+                {
+                    sort(vecTmp.data() + iBeg, vecTmp.data() + iBeg + iLen);
+                    pSorted = vecTmp.data() + iBeg;
+                }
+                else
+                {
+                    pSorted = lsdPasses(vecTmp.data() + iBeg, arr.data() + iBeg, iLen, iShift);
+                }
+                if (pSorted != arr.data() + iBeg)
+                {
+                    memcpy(arr.data() + iBeg, pSorted, iLen * sizeof(T));
+                }
+            }
+        });
+    }
+
+    //Runs fn(0..iThreads-1), index 0 on the calling thread.
+    template <typename Fn>
+    void runOnThreads(int iThreads, Fn fn)
+    {
+        vector<thread> vec_Threads;
+        for (int i=1; i<iThreads; ++i)
+        {
+            vec_Threads.emplace_back(fn, i);
+        }
+        fn(0);
+        for (auto& t : vec_Threads) t.join();
+    }
+};
@@ -0,0 +1,402 @@
+#ifndef ARRAYS_ALGORITHMS_SORT_H
+#define ARRAYS_ALGORITHMS_SORT_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/*
+Generic header only sort API, same algorithms as MergeSort.cpp / QuickSort.cpp / RadixSort.cpp
+but over any random access range with a comparator and a projection (key extractor).
+
+    struct Order { long long id; string payload; };
+    Sorting::sort(v.begin(), v.end());                                  //Plain values.
+    Sorting::stableSort(v.begin(), v.end(), std::less<>(), &Order::id); //Records by key.
+    Sorting::quickSort(v.begin(), v.end(), std::greater<>());
+
+Elements are only ever moved (swap / move assign), never copied, so heavy payloads are cheap
+to sort. Key type is found at compile time...
+    integral key + default less  -> LSD radix on the key (stable, no comparisons).
+    arithmetic key + default less -> branchless block partition in quickSort.
+    anything else                 -> classic partition / merge with the given comparator.
+
+Requires C++17.
+*/
+namespace Sorting
+{
+
+struct Identity
+{
+    template <typename T>
+    constexpr T&& operator()(T&& t) const noexcept { return std::forward<T>(t); }
+};
+
+namespace detail
+{
+    static const int INSERTION_MAX   = 16;
+    static const int RADIX_MIN       = 64;
+    static const int BLOCK_SIZE      = 64;
+    static const int DUP_SAMPLE_MIN  = 128;
+    static const int DUP_SAMPLE_SIZE = 31;
+
+    template <typename It, typename Proj>
+    using KeyOf = std::decay_t<std::invoke_result_t<Proj&, typename std::iterator_traits<It>::reference>>;
+
+    template <typename Comp, typename K>
+    constexpr bool isDefaultLess = std::is_same_v<Comp, std::less<>> || std::is_same_v<Comp, std::less<K>>;
+
+    template <typename Comp, typename K>
+    constexpr bool useRadix = std::is_integral_v<K> && !std::is_same_v<K, bool> && isDefaultLess<Comp, K>;
+
+    template <typename Comp, typename K>
+    constexpr bool useBranchless = std::is_arithmetic_v<K> && isDefaultLess<Comp, K>;
+
+    //Compares two elements through the projection.
+    template <typename Comp, typename Proj>
+    struct ProjLess
+    {
+        Comp& comp;
+        Proj& proj;
+        template <typename A, typename B>
+        bool operator()(A&& a, B&& b) const
+        {
+            return std::invoke(comp, std::invoke(proj, std::forward<A>(a)), std::invoke(proj, std::forward<B>(b)));
+        }
+    };
+
+    template <typename It, typename Less>
+    void insertionSort(It first, It last, Less& less)
+    {
+        if (last - first < 2) return;
+        for (It i = first + 1; i != last; ++i)
+        {
+            if (less(*i, *(i - 1)))
+            {
+                auto tmp = std::move(*i);
+                It j = i;
+                do
+                {
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (j != first && less(tmp, *(j - 1)));
+                *j = std::move(tmp);
+            }
+        }
+    }
+
+    /*
+    Top down merge sort, sorts both halves in place then merges with a buffer of only the
+    left half (moved out, not copied). Buffer capacity is reused by every merge.
+    Merge is skipped when the halves are already in order (last of left <= first of right).
+    */
+    template <typename It, typename Less, typename V>
+    void mergeSortRec(It first, It last, Less& less, std::vector<V>& vecBuf)
+    {
+        if (last - first <= INSERTION_MAX)
+        {
+            insertionSort(first, last, less);
+            return;
+        }
+        It mid = first + (last - first) / 2;
+        mergeSortRec(first, mid, less, vecBuf);
+        mergeSortRec(mid, last, less, vecBuf);
+        if (!less(*mid, *(mid - 1))) return;
+
+        vecBuf.assign(std::make_move_iterator(first), std::make_move_iterator(mid));
+        auto itL = vecBuf.begin(), itLEnd = vecBuf.end();
+        It itR = mid, itOut = first;
+        while (itL != itLEnd && itR != last)
+        {
+            if (less(*itR, *itL)) *itOut++ = std::move(*itR++);     //Ties take left, keeps it stable.
+            else                  *itOut++ = std::move(*itL++);
+        }
+        std::move(itL, itLEnd, itOut);              //Right leftovers are already in place.
+    }
+
+    //Median of first, middle, last moved to *first.
+    template <typename It, typename Less>
+    void medianOf3ToFirst(It first, It last, Less& less)
+    {
+        It mid = first + (last - first) / 2, back = last - 1;
+        if (less(*mid, *first)) std::iter_swap(mid, first);
+        if (less(*back, *first)) std::iter_swap(back, first);
+        if (less(*back, *mid)) std::iter_swap(back, mid);
+        std::iter_swap(first, mid);
+    }
+
+    /*
+    Same sampling as Solution::hasManyDuplicates in QuickSort.cpp but on iterators,
+    so no element is copied. On true the sample median is swapped to *first.
+    */
+    template <typename It, typename Less>
+    bool hasManyDuplicates(It first, It last, Less& less)
+    {
+        auto iSize = last - first;
+        if (iSize < DUP_SAMPLE_MIN) return false;
+
+        It arrSample[DUP_SAMPLE_SIZE];
+        auto iStep = iSize / DUP_SAMPLE_SIZE;
+        for (int i=0; i<DUP_SAMPLE_SIZE; ++i) arrSample[i] = first + i * iStep;
+        std::sort(arrSample, arrSample + DUP_SAMPLE_SIZE, [&](It a, It b) { return less(*a, *b); });
+
+        int iDupCnt = 0;
+        for (int i=1; i<DUP_SAMPLE_SIZE; ++i)
+        {
+            if (!less(*arrSample[i-1], *arrSample[i])) ++iDupCnt;
+        }
+        if (iDupCnt * 4 < DUP_SAMPLE_SIZE) return false;
+        std::iter_swap(first, arrSample[DUP_SAMPLE_SIZE / 2]);
+        return true;
+    }
+
+    /*
+    Three way partition of [first+1, last) around pivot *first, pivot is not moved until the end.
+    Returns [lt, gt) holding all keys equal to the pivot.
+    */
+    template <typename It, typename Less>
+    std::pair<It, It> partition3(It first, It last, Less& less)
+    {
+        It lt = first + 1, i = first + 1, gt = last;
+        while (i != gt)
+        {
+            if (less(*i, *first))       std::iter_swap(lt++, i++);
+            else if (less(*first, *i))  std::iter_swap(i, --gt);
+            else                        ++i;
+        }
+        std::iter_swap(first, --lt);
+        return {lt, gt};
+    }
+
+    /*
+    Splits [l, r) by pivot (which lives outside the range), returns first element >= pivot.
+    With Branchless = true this is the block partition of QuickSort.cpp, comparison results
+    only feed offset counters. For user comparators (may be costly, may not be a plain
+    compare) the classic scan is used.
+    */
+    template <bool Branchless, typename It, typename Less, typename P>
+    It partitionByPivot(It l, It r, const P& pivot, Less& less)
+    {
+        if constexpr (Branchless)
+        {
+            unsigned char arrOffL[BLOCK_SIZE], arrOffR[BLOCK_SIZE];
+            int iNumL = 0, iNumR = 0, iStartL = 0, iStartR = 0;
+            while (r - l > 2 * BLOCK_SIZE)
+            {
+                if (0 == iNumL)
+                {
+                    iStartL = 0;
+                    for (int i=0; i<BLOCK_SIZE; ++i)
+                    {
+                        arrOffL[iNumL] = (unsigned char)i;
+                        iNumL += !less(l[i], pivot);
+                    }
+                }
+                if (0 == iNumR)
+                {
+                    iStartR = 0;
+                    for (int i=0; i<BLOCK_SIZE; ++i)
+                    {
+                        arrOffR[iNumR] = (unsigned char)i;
+                        iNumR += less(r[-1 - i], pivot);
+                    }
+                }
+                int iNum = std::min(iNumL, iNumR);
+                for (int i=0; i<iNum; ++i)
+                {
+                    std::iter_swap(l + arrOffL[iStartL + i], r - 1 - arrOffR[iStartR + i]);
+                }
+                iNumL -= iNum; iNumR -= iNum;
+                iStartL += iNum; iStartR += iNum;
+                if (0 == iNumL) l += BLOCK_SIZE;
+                if (0 == iNumR) r -= BLOCK_SIZE;
+            }
+        }
+        while (true)
+        {
+            while (l != r && less(*l, pivot)) ++l;
+            while (l != r && !less(*(r - 1), pivot)) --r;
+            if (l == r) return l;
+            std::iter_swap(l, r - 1);
+            ++l; --r;
+        }
+    }
+
+    /*
+    Introsort: quick sort that falls back to heap sort after 2*log2(n) bad splits, so the
+    worst case stays O(nlog(n)). Recurses into the smaller side and loops on the larger,
+    stack depth is O(log(n)).
+    */
+    template <bool Branchless, typename It, typename Less>
+    void quickSortRec(It first, It last, Less& less, int iDepth)
+    {
+        while (last - first > INSERTION_MAX)
+        {
+            if (0 == iDepth--)
+            {
+                std::make_heap(first, last, less);
+                std::sort_heap(first, last, less);
+                return;
+            }
+
+            It leftEnd, rightBeg;
+            if (hasManyDuplicates(first, last, less))
+            {
+                auto eq = partition3(first, last, less);
+                leftEnd = eq.first; rightBeg = eq.second;
+            }
+            else
+            {
+                medianOf3ToFirst(first, last, less);
+                It split = partitionByPivot<Branchless>(first + 1, last, *first, less);
+                std::iter_swap(first, split - 1);
+                leftEnd = split - 1; rightBeg = split;
+            }
+
+            if (leftEnd - first < last - rightBeg)
+            {
+                quickSortRec<Branchless>(first, leftEnd, less, iDepth);
+                first = rightBeg;
+            }
+            else
+            {
+                quickSortRec<Branchless>(rightBeg, last, less, iDepth);
+                last = leftEnd;
+            }
+        }
+        insertionSort(first, last, less);
+    }
+
+    /*
+    Stable LSD radix sort of records by integral key (see RadixSort.cpp for the rationale).
+    Records are moved once into a buffer, then ping pong between buffer and range by move
+    assignment, digits where every key agrees are skipped.
+    */
+    template <typename It, typename Proj>
+    void radixSortRange(It first, It last, Proj& proj)
+    {
+        using V = typename std::iterator_traits<It>::value_type;
+        using K = KeyOf<It, Proj>;
+        using U = std::make_unsigned_t<K>;
+        const int iBits = sizeof(K) * 8;
+        const int D = (sizeof(K) <= 4) ? 8 : 11;
+        const size_t iBuckets = (size_t)1 << D;
+        const int iPasses = (iBits + D - 1) / D;
+
+        auto key = [&](const V& v) -> U {
+            U u = (U)std::invoke(proj, v);
+            if constexpr (std::is_signed_v<K>) u ^= (U)1 << (iBits - 1);
+            return u;
+        };
+
+        size_t n = last - first;
+        std::vector<V> vecBuf(std::make_move_iterator(first), std::make_move_iterator(last));
+        std::vector<size_t> vecHist(iPasses * iBuckets, 0);
+        for (const V& v : vecBuf)
+        {
+            U u = key(v);
+            for (int p=0; p<iPasses; ++p) ++vecHist[p * iBuckets + ((u >> (p * D)) & (iBuckets - 1))];
+        }
+
+        bool bInBuf = true;
+        for (int p=0; p<iPasses; ++p)
+        {
+            size_t* pHist = &vecHist[p * iBuckets];
+            U uFirst = bInBuf ? key(vecBuf[0]) : key(*first);
+            if (pHist[(uFirst >> (p * D)) & (iBuckets - 1)] == n) continue;
+
+            size_t iSum = 0;
+            for (size_t b=0; b<iBuckets; ++b)
+            {
+                size_t iCnt = pHist[b];
+                pHist[b] = iSum;
+                iSum += iCnt;
+            }
+            if (bInBuf)
+            {
+                for (V& v : vecBuf) first[pHist[(key(v) >> (p * D)) & (iBuckets - 1)]++] = std::move(v);
+            }
+            else
+            {
+                for (It it = first; it != last; ++it) vecBuf[pHist[(key(*it) >> (p * D)) & (iBuckets - 1)]++] = std::move(*it);
+            }
+            bInBuf = !bInBuf;
+        }
+        if (bInBuf) std::move(vecBuf.begin(), vecBuf.end(), first);
+    }
+
+    inline int introDepth(size_t n)
+    {
+        int iDepth = 0;
+        for (; n > 1; n >>= 1) iDepth += 2;
+        return iDepth;
+    }
+}
+
+//Stable merge sort, O(nlog(n)) comparisons & O(n/2) extra moved-into storage.
+template <typename It, typename Comp = std::less<>, typename Proj = Identity>
+void mergeSort(It first, It last, Comp comp = {}, Proj proj = {})
+{
+    using V = typename std::iterator_traits<It>::value_type;
+    detail::ProjLess<Comp, Proj> less{comp, proj};
+    std::vector<V> vecBuf;
+    vecBuf.reserve((last - first) / 2 + 1);
+    detail::mergeSortRec(first, last, less, vecBuf);
+}
+
+//Unstable introsort, O(nlog(n)) worst case, O(log(n)) stack & no heap allocation.
+template <typename It, typename Comp = std::less<>, typename Proj = Identity>
+void quickSort(It first, It last, Comp comp = {}, Proj proj = {})
+{
+    using K = detail::KeyOf<It, Proj>;
+    detail::ProjLess<Comp, Proj> less{comp, proj};
+    detail::quickSortRec<detail::useBranchless<Comp, K>>(first, last, less, detail::introDepth(last - first));
+}
+
+//Stable LSD radix sort by an integral key, ascending.
+template <typename It, typename Proj = Identity>
+void radixSort(It first, It last, Proj proj = {})
+{
+    static_assert(std::is_integral_v<detail::KeyOf<It, Proj>>, "radixSort needs an integral key");
+    if (last - first < 2) return;
+    detail::radixSortRange(first, last, proj);
+}
+
+//Fastest unstable sort for the key type, picked at compile time.
+template <typename It, typename Comp = std::less<>, typename Proj = Identity>
+void sort(It first, It last, Comp comp = {}, Proj proj = {})
+{
+    using K = detail::KeyOf<It, Proj>;
+    if constexpr (detail::useRadix<Comp, K>)
+    {
+        if (last - first >= detail::RADIX_MIN)
+        {
+            detail::radixSortRange(first, last, proj);
+            return;
+        }
+    }
+    Sorting::quickSort(first, last, comp, proj);
+}
+
+//Fastest stable sort for the key type, picked at compile time.
+template <typename It, typename Comp = std::less<>, typename Proj = Identity>
+void stableSort(It first, It last, Comp comp = {}, Proj proj = {})
+{
+    using K = detail::KeyOf<It, Proj>;
+    if constexpr (detail::useRadix<Comp, K>)
+    {
+        if (last - first >= detail::RADIX_MIN)
+        {
+            detail::radixSortRange(first, last, proj);
+            return;
+        }
+    }
+    Sorting::mergeSort(first, last, comp, proj);
+}
+
+}
+
+#endif
@@ -0,0 +1,220 @@
+#include <bits/stdc++.h>
+using namespace std;
+using namespace std::chrono;
+typedef long long int lli;
+
+//Every file below has its own "class Solution", namespaces keep them apart.
+namespace MergeSortSol {
+#include "MergeSort.cpp"
+}
+namespace QuickSortSol {
+#include "QuickSort.cpp"
+}
+namespace RadixSortSol {
+#include "RadixSort.cpp"
+}
+#include "Sort.h"
+#include "../../Utils/PerfCounter.h"
+
+/*
+Sort benchmark & correctness harness for Arrays/Algorithms.
+Every algorithm runs over every input distribution for sizes 1K, 10K .. max size and
+2 x PARALLEL_RADIX_MIN (the parallel MSD path of parallelRadixSort starts there), each result
+is compared with std::sort of the same input. Reported per run...
+    ns/element   wall time / n (small sizes are repeated to get a stable number)
+    IPC, LLC & branch misses per element, context switches from Utils/PerfCounter.h,
+                 "n/a" where perf_event_open is not permitted.
+Exit code is 1 if any algorithm produced a wrong result.
+Threads default to the hardware threads but at least 2, so the parallel paths run on one core too.
+
+Compile: g++ -O3 -std=c++17 -pthread -march=native SortBench.cpp
+Run    : ./a.out [max size (default 10M, up to 100M)] [threads]
+         ./a.out speedup [size] [max threads]        Parallel quick sort speedup for 1..N threads.
+*/
+
+
+/*
+Input distributions.
+m3-killer = Musser's median of 3 killer, drives a first/middle/last pivot to pick the 2nd
+smallest element every round which makes a naive quick sort O(n^2).
+*/
+vector<int> makeInput(const string& strDist, int n, mt19937& rng)
+{
+    vector<int> arr(n);
+    if ("random" == strDist)
+    {
+        for (auto& x : arr) x = (int)rng();
+    }
+    else if ("sorted" == strDist)
+    {
+        iota(arr.begin(), arr.end(), 0);
+    }
+    else if ("reversed" == strDist)
+    {
+        for (int i=0; i<n; ++i) arr[i] = n - i;
+    }
+    else if ("few-unique" == strDist)
+    {
+        for (auto& x : arr) x = (int)(rng() % 256);
+    }
+    else if ("organ-pipe" == strDist)
+    {
+        for (int i=0; i<n; ++i) arr[i] = (i < n / 2) ? i : n - i;
+    }
+    else if ("m3-killer" == strDist)
+    {
+        int k = n / 2;
+        for (int i=1; i<=k; ++i)
+        {
+            if (i & 1) { arr[i-1] = i; arr[i] = k + i; }
+            arr[k + i - 1] = 2 * i;
+        }
+        if (n & 1) arr[n-1] = n;
+    }
+    return arr;
+}
+
+struct Algo
+{
+    string name;
+    function<void(vector<int>&)> fn;
+};
+
+vector<Algo> makeAlgos(int iThreads)
+{
+    return {
+        {"std::sort",          [](vector<int>& a) { sort(a.begin(), a.end()); }},
+        {"mergeSort",          [](vector<int>& a) { MergeSortSol::Solution().mergeSort(a, 0, (int)a.size() - 1); }},
+        {"adaptiveMergeSort",  [](vector<int>& a) { MergeSortSol::Solution().adaptiveMergeSort(a, 0, (int)a.size() - 1); }},
+        {"quickSort",          [](vector<int>& a) { QuickSortSol::Solution().quickSort(a, 0, (int)a.size() - 1); }},
+        {"parallelQuickSort",  [=](vector<int>& a) { QuickSortSol::Solution().parallelQuickSort(a, 0, (int)a.size() - 1, iThreads); }},
+        {"radixSort",          [](vector<int>& a) { RadixSortSol::Solution().radixSort(a); }},
+        {"parallelRadixSort",  [=](vector<int>& a) { RadixSortSol::Solution().parallelRadixSort(a, iThreads); }},
+        {"Sorting::sort",      [](vector<int>& a) { Sorting::sort(a.begin(), a.end()); }},
+        {"Sorting::quickSort", [](vector<int>& a) { Sorting::quickSort(a.begin(), a.end()); }},
+        {"Sorting::mergeSort", [](vector<int>& a) { Sorting::mergeSort(a.begin(), a.end()); }},
+    };
+}
+
+int runSuite(lli iMaxSize, int iThreads)
+{
+    const vector<string> vecDists = {"random", "sorted", "reversed", "few-unique", "organ-pipe", "m3-killer"};
+    vector<Algo> vecAlgos = makeAlgos(iThreads);
+    PerfCounters counters;
+    mt19937 rng(42);
+    int iFailures = 0;
+
+    cout << "\nSort benchmark, threads = " << iThreads << "\n";
+    if (!counters.status().empty()) cout << "Note: " << counters.status() << "\n";
+    cout << fixed << setprecision(2);
+    cout << setw(12) << "Dist" << setw(11) << "N" << setw(21) << "Algorithm" << setw(13) << "ns/element";
+    PerfSample::printHeader(cout);
+    cout << setw(8) << "Check" << "\n";
+    cout << string(110, '-') << "\n";
+
+    vector<lli> vecSizes;
+    for (lli n = 1000; n <= iMaxSize; n *= 10) vecSizes.push_back(n);
+    lli iMsdSize = 2 * RadixSortSol::Solution::PARALLEL_RADIX_MIN;
+    if (iMsdSize <= iMaxSize) vecSizes.push_back(iMsdSize);
+    sort(vecSizes.begin(), vecSizes.end());
+
+    for (lli n : vecSizes)
+    {
+        for (const string& strDist : vecDists)
+        {
+            vector<int> vecInput = makeInput(strDist, (int)n, rng);
+            vector<int> vecExpected = vecInput;
+            sort(vecExpected.begin(), vecExpected.end());
+            int iReps = (int)max<lli>(1, 1'000'000 / n);
+
+            for (const Algo& algo : vecAlgos)
+            {
+                vector<int> arr;
+                double dSec = 0;
+                PerfSample total;
+                bool bOk = true;
+                for (int r=0; r<iReps; ++r)
+                {
+                    arr = vecInput;
+                    PerfSample sample;
+                    auto startTime = high_resolution_clock::now();
+                    {
+                        ScopedPerfCounter scope(counters, sample);
+                        algo.fn(arr);
+                    }
+                    auto endTime = high_resolution_clock::now();
+                    if (0 == r) total = sample;
+                    else        total += sample;
+                    dSec += duration_cast<nanoseconds>(endTime - startTime).count() / 1e9;
+                    bOk = bOk && (arr == vecExpected);
+                }
+                if (!bOk) ++iFailures;
+
+                double dElems = (double)n * iReps;
+                cout << setw(12) << strDist << setw(11) << n << setw(21) << algo.name
+                     << setw(13) << dSec * 1e9 / dElems;
+                total.print(cout, dElems);
+                cout << setw(8) << (bOk ? "OK" : "FAIL") << "\n";
+            }
+            cout << "\n";
+        }
+    }
+    cout << (iFailures ? "FAILED : " + to_string(iFailures) + " wrong results!\n" : "All results match std::sort.\n");
+    return iFailures ? 1 : 0;
+}
+
+int runSpeedup(lli iSize, int iMaxThreads)
+{
+    mt19937 rng(42);
+    vector<int> i_vecInput = makeInput("random", (int)iSize, rng);
+    vector<int> i_vecExpected = i_vecInput;
+    sort(i_vecExpected.begin(), i_vecExpected.end());
+
+    cout << "\nParallel QuickSort, n = " << iSize << "\n";
+    cout << fixed << setprecision(3);
+    cout << setw(10) << "Threads"
+         << setw(12) << "Time (s)"
+         << setw(12) << "Speedup"
+         << setw(14) << "ns/element" << "\n";
+    cout << string(48, '-') << "\n";
+
+    double dBase = 0;
+    vector<int> vecThreads;
+    for (int t = 1; t < iMaxThreads; t *= 2) vecThreads.push_back(t);
+    vecThreads.push_back(iMaxThreads);
+
+    for (int iThreads : vecThreads)
+    {
+        vector<int> arr = i_vecInput;
+        auto startTime = high_resolution_clock::now();
+        QuickSortSol::Solution().parallelQuickSort(arr, 0, (int)arr.size() - 1, iThreads);
+        auto endTime = high_resolution_clock::now();
+        double dSec = duration_cast<microseconds>(endTime - startTime).count() / 1e6;
+        if (arr != i_vecExpected)
+        {
+            cout << "FAILED : result differs from std::sort with " << iThreads << " threads!\n";
+            return 1;
+        }
+        if (1 == iThreads) dBase = dSec;
+
+        cout << setw(10) << iThreads
+             << setw(12) << dSec
+             << setw(11) << dBase / dSec << "x"
+             << setw(14) << dSec * 1e9 / iSize << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int iHwThreads = max(1u, thread::hardware_concurrency());
+    if (argc > 1 && string("speedup") == argv[1])
+    {
+        lli iSize = (argc > 2) ? atoll(argv[2]) : 20'000'000;
+        int iMaxThreads = (argc > 3) ? atoi(argv[3]) : iHwThreads;
+        return runSpeedup(iSize, iMaxThreads);
+    }
+    lli iMaxSize = (argc > 1) ? atoll(argv[1]) : 10'000'000;
+    int iThreads = (argc > 2) ? atoi(argv[2]) : max(2, iHwThreads);
+    return runSuite(iMaxSize, iThreads);
+}
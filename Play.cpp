@@ -7,303 +7,107 @@
 #include <mutex>
 #include <iomanip>
 #include <array>
+#include <queue>
+#include "Utils/PerfCounter.h"
+#include "Utils/BatchCounter.h"
+#include "Queue/LockFreeQueue.h"
+#include "Queue/PriorityQueue.h"
 
 using namespace std;
 using namespace std::chrono;
 
 // ============================================================================
-// EPOCH-BASED RECLAMATION (Much faster than Hazard Pointers!)
+// MUTEX-BASED QUEUE
 // ============================================================================
 
-template<typename T>
-class EpochManager
+template <typename T>
+class MutexQueue
 {
 private:
-    static constexpr size_t MAX_THREADS = 16;
-    static constexpr size_t EPOCH_FREQ = 100;  // Update epoch every N operations
-    
-    struct alignas(64) ThreadData
-    {
-        atomic<uint64_t> local_epoch{0};
-        atomic<bool> active{false};
-        uint64_t op_count{0};
-        vector<T*> retired[3];  // One vector per epoch
-    };
-    
-    alignas(64) atomic<uint64_t> global_epoch{0};
-    static ThreadData thread_data[MAX_THREADS];
-    static thread_local size_t thread_id;
-    static atomic<size_t> thread_counter;
-    
-    static size_t get_thread_id()
-    {
-        static thread_local bool initialized = false;
-        if (!initialized)
-        {
-            thread_id = thread_counter.fetch_add(1, memory_order_relaxed) % MAX_THREADS;
-            initialized = true;
-        }
-        return thread_id;
-    }
-    
-    void try_update_epoch()
-    {
-        size_t tid = get_thread_id();
-        ThreadData& td = thread_data[tid];
-        
-        if (++td.op_count % EPOCH_FREQ == 0)
-        {
-            uint64_t ge = global_epoch.load(memory_order_acquire);
-            td.local_epoch.store(ge, memory_order_release);
-        }
-    }
-    
-    uint64_t compute_min_epoch()
-    {
-        uint64_t min_epoch = global_epoch.load(memory_order_acquire);
-        
-        for (size_t i = 0; i < MAX_THREADS; ++i)
-        {
-            if (thread_data[i].active.load(memory_order_acquire))
-            {
-                uint64_t le = thread_data[i].local_epoch.load(memory_order_acquire);
-                if (le < min_epoch)
-                    min_epoch = le;
-            }
-        }
-        
-        return min_epoch;
-    }
+    list<T> m_queue;
+    mutex m_mutex;
     
 public:
-    EpochManager() = default;
-    
-    void enter()
-    {
-        size_t tid = get_thread_id();
-        ThreadData& td = thread_data[tid];
-        
-        td.active.store(true, memory_order_release);
-        uint64_t ge = global_epoch.load(memory_order_acquire);
-        td.local_epoch.store(ge, memory_order_release);
-    }
-    
-    void exit()
+    bool enqueue(const T& value)
     {
-        size_t tid = get_thread_id();
-        thread_data[tid].active.store(false, memory_order_release);
+        lock_guard<mutex> lock(m_mutex);
+        m_queue.push_back(value);
+        return true;
     }
-    
-    void retire(T* ptr)
+
+    bool dequeue(T& result)
     {
-        if (!ptr) return;
-        
-        size_t tid = get_thread_id();
-        ThreadData& td = thread_data[tid];
-        
-        try_update_epoch();
-        
-        uint64_t ge = global_epoch.load(memory_order_acquire);
-        td.retired[ge % 3].push_back(ptr);
+        lock_guard<mutex> lock(m_mutex);
+        if (m_queue.empty())
+            return false;
         
-        // Try to reclaim old epochs
-        if (td.retired[ge % 3].size() > 100)
-        {
-            uint64_t min_epoch = compute_min_epoch();
-            
-            if (min_epoch > 0)
-            {
-                uint64_t safe_epoch = (min_epoch - 1) % 3;
-                for (T* p : td.retired[safe_epoch])
-                {
-                    delete p;
-                }
-                td.retired[safe_epoch].clear();
-            }
-        }
-    }
-    
-    void advance_epoch()
-    {
-        global_epoch.fetch_add(1, memory_order_acq_rel);
-    }
-    
-    ~EpochManager()
-    {
-        // Cleanup all retired nodes
-        for (size_t i = 0; i < MAX_THREADS; ++i)
-        {
-            for (int e = 0; e < 3; ++e)
-            {
-                for (T* ptr : thread_data[i].retired[e])
-                {
-                    delete ptr;
-                }
-            }
-        }
+        result = m_queue.front();
+        m_queue.pop_front();
+        return true;
     }
 };
 
-template<typename T>
-typename EpochManager<T>::ThreadData EpochManager<T>::thread_data[EpochManager<T>::MAX_THREADS];
-template<typename T>
-thread_local size_t EpochManager<T>::thread_id{0};
-template<typename T>
-atomic<size_t> EpochManager<T>::thread_counter{0};
-
 // ============================================================================
-// LOCK-FREE QUEUE WITH EPOCH-BASED RECLAMATION
+// PRIORITY QUEUES (LevelPriorityQueue & MultiQueue in Queue/PriorityQueue.h)
 // ============================================================================
 
 template <typename T>
-class LockFreeQueue
+class MutexPriorityQueue
 {
 private:
-    struct Node
+    struct Entry
     {
+        uint64_t priority;
+        uint64_t seq;       // FIFO among equal priorities, like the level lanes
         T data;
-        atomic<Node*> next;
-        
-        Node() : data{}, next{nullptr} {}
-        explicit Node(const T& val) : data(val), next{nullptr} {}
+        bool operator<(const Entry& other) const
+        {
+            return priority != other.priority ? priority > other.priority : seq > other.seq;
+        }
     };
-
-    alignas(64) atomic<Node*> m_head;
-    alignas(64) atomic<Node*> m_tail;
-    EpochManager<Node> epoch_mgr;
+    priority_queue<Entry> m_heap;
+    uint64_t m_seq{0};
+    mutex m_mutex;
 
 public:
-    LockFreeQueue()
+    bool enqueue(const T& value, uint64_t priority)
     {
-        Node* dummy = new Node();
-        m_head.store(dummy, memory_order_relaxed);
-        m_tail.store(dummy, memory_order_relaxed);
-    }
-    
-    ~LockFreeQueue()
-    {
-        Node* current = m_head.load(memory_order_relaxed);
-        while (current)
-        {
-            Node* next = current->next.load(memory_order_relaxed);
-            delete current;
-            current = next;
-        }
-    }
-    
-    LockFreeQueue(const LockFreeQueue&) = delete;
-    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
-    
-    bool enqueue(const T& value)
-    {
-        epoch_mgr.enter();
-        
-        Node* newNode = new Node(value);
-        
-        while (true)
-        {
-            Node* tail = m_tail.load(memory_order_acquire);
-            Node* next = tail->next.load(memory_order_acquire);
-            
-            if (tail == m_tail.load(memory_order_acquire))
-            {
-                if (next == nullptr)
-                {
-                    if (tail->next.compare_exchange_weak(next, newNode,
-                                                         memory_order_release,
-                                                         memory_order_acquire))
-                    {
-                        m_tail.compare_exchange_weak(tail, newNode,
-                                                    memory_order_release,
-                                                    memory_order_relaxed);
-                        epoch_mgr.exit();
-                        return true;
-                    }
-                }
-                else
-                {
-                    m_tail.compare_exchange_weak(tail, next,
-                                                memory_order_release,
-                                                memory_order_relaxed);
-                }
-            }
-        }
+        lock_guard<mutex> lock(m_mutex);
+        m_heap.push(Entry{priority, m_seq++, value});
+        return true;
     }
 
     bool dequeue(T& result)
     {
-        epoch_mgr.enter();
-        
-        while (true)
-        {
-            Node* head = m_head.load(memory_order_acquire);
-            Node* tail = m_tail.load(memory_order_acquire);
-            Node* next = head->next.load(memory_order_acquire);
-            
-            if (head == m_head.load(memory_order_acquire))
-            {
-                if (head == tail)
-                {
-                    if (next == nullptr)
-                    {
-                        epoch_mgr.exit();
-                        return false;
-                    }
-                    
-                    m_tail.compare_exchange_weak(tail, next,
-                                                memory_order_release,
-                                                memory_order_relaxed);
-                }
-                else
-                {
-                    if (next == nullptr)
-                        continue;
-                    
-                    result = next->data;
-                    
-                    if (m_head.compare_exchange_weak(head, next,
-                                                     memory_order_release,
-                                                     memory_order_acquire))
-                    {
-                        epoch_mgr.retire(head);
-                        epoch_mgr.exit();
-                        return true;
-                    }
-                }
-            }
-        }
+        lock_guard<mutex> lock(m_mutex);
+        if (m_heap.empty())
+            return false;
+
+        result = m_heap.top().data;
+        m_heap.pop();
+        return true;
     }
 };
 
-// ============================================================================
-// MUTEX-BASED QUEUE
-// ============================================================================
-
-template <typename T>
-class MutexQueue
+// Benchmark only calls enqueue(value), this gives every item a priority of
+// priority_bits bits spread by a multiplicative hash of the value
+template <typename PQ>
+class PriorityMix
 {
 private:
-    list<T> m_queue;
-    mutex m_mutex;
-    
+    PQ& pq;
+    int priority_bits;
+
 public:
-    bool enqueue(const T& value)
-    {
-        lock_guard<mutex> lock(m_mutex);
-        m_queue.push_back(value);
-        return true;
-    }
+    PriorityMix(PQ& q, int bits) : pq(q), priority_bits(bits) {}
 
-    bool dequeue(T& result)
+    bool enqueue(const long long& value)
     {
-        lock_guard<mutex> lock(m_mutex);
-        if (m_queue.empty())
-            return false;
-        
-        result = m_queue.front();
-        m_queue.pop_front();
-        return true;
+        uint64_t priority = ((uint64_t)value * 11400714819323198485ULL) >> (64 - priority_bits);
+        return pq.enqueue(value, priority);
     }
+
+    bool dequeue(long long& result) { return pq.dequeue(result); }
 };
 
 // ============================================================================
@@ -315,8 +119,9 @@ class Benchmark
 {
 private:
     Queue& queue;
-    atomic<long long> total_dequeued{0};
-    atomic<bool> producers_done{false};
+    PerfCounters& counters;
+    PerfSample last_perf;
+    FinishFlag producers_done;
     
     void producer(long long items_per_thread)
     {
@@ -326,38 +131,42 @@ private:
         }
     }
     
-    void consumer(long long total_items)
+    // Counts locally (see Utils/BatchCounter.h), the shared flag is read
+    // only when the queue looked empty
+    void consumer(BatchCounter& dequeued, size_t slot)
     {
+        BatchCounter::Local count(dequeued, slot);
         long long value;
         
         while (true)
         {
             if (queue.dequeue(value))
             {
-                long long count = total_dequeued.fetch_add(1, memory_order_relaxed) + 1;
-                if (count >= total_items)
-                    return;
+                count.add();
             }
-            else
+            else if (producers_done.isRaised())
             {
-                if (producers_done.load(memory_order_acquire) && 
-                    total_dequeued.load(memory_order_relaxed) >= total_items)
-                    return;
+                // Every enqueue happened before the flag, drain the rest & stop
+                while (queue.dequeue(value))
+                    count.add();
+                return;
             }
         }
     }
     
 public:
-    Benchmark(Queue& q) : queue(q) {}
+    Benchmark(Queue& q, PerfCounters& c) : queue(q), counters(c) {}
+    
+    // Counters of the last run(), producers & consumers included
+    const PerfSample& perf() const { return last_perf; }
     
     double run(int num_producers, int num_consumers, long long items_per_producer)
     {
-        total_dequeued.store(0);
-        producers_done.store(false);
-        
-        long long total_items = num_producers * items_per_producer;
+        BatchCounter dequeued(num_consumers);
+        producers_done.reset();
         
         auto start = high_resolution_clock::now();
+        ScopedPerfCounter scope(counters, last_perf);
         
         vector<thread> producers;
         for (int i = 0; i < num_producers; ++i)
@@ -365,17 +174,19 @@ public:
         
         vector<thread> consumers;
         for (int i = 0; i < num_consumers; ++i)
-            consumers.emplace_back(&Benchmark::consumer, this, total_items);
+            consumers.emplace_back(&Benchmark::consumer, this, ref(dequeued), (size_t)i);
         
         for (auto& t : producers)
             t.join();
         
-        producers_done.store(true, memory_order_release);
+        producers_done.raise();
         
         for (auto& t : consumers)
             t.join();
         
         auto end = high_resolution_clock::now();
+        if (dequeued.total() != num_producers * items_per_producer)
+            cerr << "Lost items: " << dequeued.total() << " of " << num_producers * items_per_producer << "\n";
         return duration_cast<microseconds>(end - start).count() / 1e6;
     }
 };
@@ -391,6 +202,7 @@ int main()
     cout << "╚═══════════════════════════════════════════════════════════════════════╝\n\n";
     
     const long long ITEMS_PER_PRODUCER = 2'500'000;
+    PerfCounters counters;  // Before any thread so workers inherit them
     
     struct TestConfig {
         int producers, consumers;
@@ -413,19 +225,28 @@ int main()
          << setw(18) << "LockFree (Mops/s)\n";
     cout << string(96, '-') << "\n";
     
+    struct PerfRow {
+        string config, queue;
+        PerfSample sample;
+        long long items;
+    };
+    vector<PerfRow> perf_rows;
+    
     for (const auto& config : configs)
     {
         long long total = config.producers * ITEMS_PER_PRODUCER;
         
         MutexQueue<long long> mq;
-        Benchmark<MutexQueue<long long>> mb(mq);
+        Benchmark<MutexQueue<long long>> mb(mq, counters);
         double mt = mb.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
         
         LockFreeQueue<long long> lfq;
-        Benchmark<LockFreeQueue<long long>> lfb(lfq);
+        Benchmark<LockFreeQueue<long long>> lfb(lfq, counters);
         double lft = lfb.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
         
         double speedup = mt / lft;
+        perf_rows.push_back({config.name, "Mutex", mb.perf(), total});
+        perf_rows.push_back({config.name, "LockFree", lfb.perf(), total});
         
         cout << setw(12) << config.name
              << setw(15) << mt
@@ -437,6 +258,75 @@ int main()
         this_thread::sleep_for(milliseconds(100));
     }
     
+    // Priority queues: 8 levels for the level queue, 20 bit priorities for the
+    // relaxed MultiQueue, the mutex heap runs both mixes as baseline. Memory of all
+    // of them follows the backlog (the level lanes free their nodes), times compare like with like
+    const int LEVEL_BITS = 3, UNBOUNDED_BITS = 20;
+
+    cout << "\nPriority queues (8 levels / 20 bit priorities)\n";
+    cout << setw(12) << "Config"
+         << setw(15) << "MutexPQ-8 (s)"
+         << setw(15) << "LevelPQ (s)"
+         << setw(16) << "MutexPQ-20 (s)"
+         << setw(16) << "MultiQueue (s)"
+         << setw(18) << "LevelPQ (Mops/s)"
+         << setw(18) << "MultiQ (Mops/s)\n";
+    cout << string(110, '-') << "\n";
+
+    for (const auto& config : configs)
+    {
+        long long total = config.producers * ITEMS_PER_PRODUCER;
+        int threads = config.producers + config.consumers;
+
+        MutexPriorityQueue<long long> mpq8;
+        PriorityMix<MutexPriorityQueue<long long>> mpq8_mix(mpq8, LEVEL_BITS);
+        Benchmark<PriorityMix<MutexPriorityQueue<long long>>> mpq8b(mpq8_mix, counters);
+        double mpq8t = mpq8b.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
+
+        LevelPriorityQueue<long long, 8, LockFreeQueue> lpq;
+        PriorityMix<LevelPriorityQueue<long long, 8, LockFreeQueue>> lpq_mix(lpq, LEVEL_BITS);
+        Benchmark<PriorityMix<LevelPriorityQueue<long long, 8, LockFreeQueue>>> lpqb(lpq_mix, counters);
+        double lpqt = lpqb.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
+
+        MutexPriorityQueue<long long> mpq20;
+        PriorityMix<MutexPriorityQueue<long long>> mpq20_mix(mpq20, UNBOUNDED_BITS);
+        Benchmark<PriorityMix<MutexPriorityQueue<long long>>> mpq20b(mpq20_mix, counters);
+        double mpq20t = mpq20b.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
+
+        MultiQueue<long long> mq(threads);
+        PriorityMix<MultiQueue<long long>> mq_mix(mq, UNBOUNDED_BITS);
+        Benchmark<PriorityMix<MultiQueue<long long>>> mqb(mq_mix, counters);
+        double mqt = mqb.run(config.producers, config.consumers, ITEMS_PER_PRODUCER);
+
+        perf_rows.push_back({config.name, "MutexPQ-8", mpq8b.perf(), total});
+        perf_rows.push_back({config.name, "LevelPQ", lpqb.perf(), total});
+        perf_rows.push_back({config.name, "MutexPQ-20", mpq20b.perf(), total});
+        perf_rows.push_back({config.name, "MultiQueue", mqb.perf(), total});
+
+        cout << setw(12) << config.name
+             << setw(15) << mpq8t
+             << setw(15) << lpqt
+             << setw(16) << mpq20t
+             << setw(16) << mqt
+             << setw(18) << (total/lpqt)/1e6
+             << setw(18) << (total/mqt)/1e6 << "\n";
+
+        this_thread::sleep_for(milliseconds(100));
+    }
+
+    cout << "\nHardware counters (per item = one enqueue + one dequeue)\n";
+    if (!counters.status().empty())
+        cout << "Note: " << counters.status() << "\n";
+    cout << setw(12) << "Config" << setw(12) << "Queue";
+    PerfSample::printHeader(cout);
+    cout << "\n" << string(69, '-') << "\n";
+    for (const auto& row : perf_rows)
+    {
+        cout << setw(12) << row.config << setw(12) << row.queue;
+        row.sample.print(cout, (double)row.items);
+        cout << "\n";
+    }
+    
     cout << "\n✓ Benchmark complete with proper memory reclamation!\n";
     cout << "  Compile: g++ -O3 -std=c++17 -pthread -march=native benchmark.cpp\n\n";
     
@@ -1,4 +1,6 @@
 #include <bits/stdc++.h>
+#include "Utils/PerfCounter.h"
+#include "Utils/BatchCounter.h"
 using namespace std;
 typedef long long int lli;
 typedef unsigned long long ull;
@@ -43,7 +45,6 @@ class SimpleQ
 
 SimpleQ<lli> q;
 
-std::mutex m1;
 void insertQ(lli st, lli end)
 {
     for (lli i=st; i<=end; ++i)
@@ -52,23 +53,21 @@ void insertQ(lli st, lli end)
     }
 }
 
-static lli iCnt = 0;
-void removeQ()
+//Consumers count in their own slot, the done flag is only read when the Q looked empty.
+BatchCounter g_dequeued(MAX_T_CNT);
+FinishFlag g_producersDone;
+void removeQ(size_t iSlot)
 {
+    BatchCounter::Local cnt(g_dequeued, iSlot);
     while (1)
     {
         lli iVal;
         if (q.dequeue(iVal)) {
-            m1.lock();
-            ++iCnt;
-            if (iCnt == MAX_TESTS*MAX_T_CNT) {
-                m1.unlock();
-                return;
-            }
-            m1.unlock();
+            cnt.add();
         }
-        else if (iCnt == MAX_TESTS*MAX_T_CNT)
+        else if (g_producersDone.isRaised())
         {
+            while (q.dequeue(iVal)) cnt.add();
             return;
         }
     }
@@ -77,29 +76,41 @@ void removeQ()
 int main()
 {
     cout << "Start" << endl;
+    PerfCounters counters;      //Before the threads so they inherit the counters.
+    PerfSample sample;
+    counters.start();
     auto startTime = std::chrono::high_resolution_clock::now();
     std::thread t1(insertQ, 1, MAX_TESTS);
     std::thread t2(insertQ, 1, MAX_TESTS);
     std::thread t3(insertQ, 1, MAX_TESTS);
     std::thread t4(insertQ, 1, MAX_TESTS);
     
-    std::thread t5(removeQ);
-    std::thread t6(removeQ);
-    std::thread t7(removeQ);
-    std::thread t8(removeQ);
+    std::thread t5(removeQ, 0);
+    std::thread t6(removeQ, 1);
+    std::thread t7(removeQ, 2);
+    std::thread t8(removeQ, 3);
 
 
     t1.join();
     t2.join();
     t3.join();
     t4.join();
+    g_producersDone.raise();
     t5.join();
     t6.join();
     t7.join();
     t8.join();
     auto endTime = std::chrono::high_resolution_clock::now();
+    counters.stop(sample);
     auto duration = duration_cast<microseconds>(endTime - startTime);
     cout<<"Sec : "<<duration.count()/(1e6)<<endl;
+    bool bOk = (g_dequeued.total() == (lli)MAX_TESTS*MAX_T_CNT);
+    cout << "Check : dequeued " << g_dequeued.total() << " -> " << (bOk ? "OK" : "FAILED") << endl;
+    if (!counters.status().empty()) cout << "Note: " << counters.status() << endl;
+    PerfSample::printHeader(cout);
+    cout << "   (per item)" << endl;
+    sample.print(cout, (double)MAX_TESTS*MAX_T_CNT);
+    cout << endl;
     cout << "Exit" << endl;
-    return 0;
+    return bOk ? 0 : 1;
 }
\ No newline at end of file
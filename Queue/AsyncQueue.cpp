@@ -0,0 +1,166 @@
+#include <bits/stdc++.h>
+#include "AsyncQueue.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+AsyncQueue demo, many consumer coroutines on a few worker threads.
+Every consumer is a coroutine looping on co_await q.pop() until it gets the -1 pill, resumed
+coroutines are posted to a small executor (worker threads draining a LockFreeQueue of handles).
+Producer threads push 0..N-1 each, the sums & counts of all consumers must match.
+steady: one producer keeps a small backlog in front of a few consumers for many items, the
+process RSS must stay flat (the item & waiter queues free their nodes as they go).
+
+Compile: g++ -O3 -std=c++20 -pthread AsyncQueue.cpp
+Run    : ./a.out [consumer coroutines (default 10000)] [items per producer] [producers] [workers]
+                 [steady items (default 20M)]
+*/
+
+const lli RSS_BUDGET = 32 << 20;
+
+//Resident set of the whole process in bytes, 0 if /proc isn't there.
+lli residentBytes()
+{
+    long lPages = 0, lResident = 0;
+    FILE* pFile = fopen("/proc/self/statm", "r");
+    if (pFile)
+    {
+        if (2 != fscanf(pFile, "%ld %ld", &lPages, &lResident)) lResident = 0;
+        fclose(pFile);
+    }
+    return (lli)lResident * sysconf(_SC_PAGESIZE);
+}
+
+//Fire & forget coroutine, starts at once and frees its frame when it returns.
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return {}; }
+        suspend_never initial_suspend() { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+};
+
+class Executor
+{
+    private:
+        LockFreeQueue<coroutine_handle<>> m_runQ;
+        atomic<bool> m_bStop{false};
+        vector<thread> m_workers;
+
+        void worker()
+        {
+            coroutine_handle<> handle;
+            while (true)
+            {
+                if (m_runQ.dequeue(handle)) handle.resume();
+                else if (m_bStop.load(memory_order_acquire)) return;
+                else this_thread::yield();
+            }
+        }
+
+    public:
+    explicit Executor(int iThreads)
+    {
+        for (int i=0; i<iThreads; ++i) m_workers.emplace_back(&Executor::worker, this);
+    }
+    ~Executor()
+    {
+        m_bStop.store(true, memory_order_release);
+        for (auto& t : m_workers) t.join();
+    }
+
+    void post(coroutine_handle<> handle) { m_runQ.enqueue(handle); }
+    static void resumer(coroutine_handle<> handle, void* pExecutor) { ((Executor*)pExecutor)->post(handle); }
+};
+
+struct Totals
+{
+    atomic<lli> m_iCount{0}, m_iSum{0};
+    atomic<int> m_iFinished{0};
+};
+
+Task consumer(AsyncQueue<lli>& q, Totals& totals)
+{
+    lli iCount = 0, iSum = 0;
+    while (true)
+    {
+        lli iVal = co_await q.pop();
+        if (-1 == iVal) break;
+        ++iCount;
+        iSum += iVal;
+    }
+    totals.m_iCount.fetch_add(iCount, memory_order_relaxed);
+    totals.m_iSum.fetch_add(iSum, memory_order_relaxed);
+    totals.m_iFinished.fetch_add(1, memory_order_release);
+}
+
+//Long running producer / consumer pair, memory must not grow with the number of items.
+bool runSteady(lli iItems, int iWorkers)
+{
+    const int CONSUMERS = 4;
+    const lli BACKLOG = 1'000;
+    Totals totals;
+    lli iBaseRss = residentBytes(), iPeakRss = iBaseRss;
+    {
+        Executor executor(iWorkers);
+        AsyncQueue<lli> q(Executor::resumer, &executor);
+        for (int i=0; i<CONSUMERS; ++i) consumer(q, totals);
+        for (lli i=0; i<iItems; ++i)
+        {
+            while (q.getBalance() > BACKLOG) this_thread::yield();
+            q.push(1);
+            if (0 == (i & 0xFFFF)) iPeakRss = max(iPeakRss, residentBytes());
+        }
+        for (int i=0; i<CONSUMERS; ++i) q.push(-1);
+        while (totals.m_iFinished.load(memory_order_acquire) < CONSUMERS) this_thread::yield();
+    }
+    lli iGrowth = iPeakRss - iBaseRss;
+    bool bOk = (totals.m_iCount == iItems) && (iGrowth <= RSS_BUDGET);
+    cout << "steady : " << totals.m_iCount << " / " << iItems << " items, peak RSS +" << iGrowth / (1 << 20)
+         << " MB (budget " << RSS_BUDGET / (1 << 20) << ") -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+int main(int argc, char** argv)
+{
+    int iConsumers = (argc > 1) ? atoi(argv[1]) : 10'000;
+    lli iItems = (argc > 2) ? atoll(argv[2]) : 1'000'000;
+    int iProducers = (argc > 3) ? atoi(argv[3]) : 4;
+    int iWorkers = (argc > 4) ? atoi(argv[4]) : 4;
+    lli iSteadyItems = (argc > 5) ? atoll(argv[5]) : 20'000'000;
+
+    Totals totals;
+    bool bOk;
+    double dSec;
+    {
+        Executor executor(iWorkers);
+        AsyncQueue<lli> q(Executor::resumer, &executor);
+
+        auto startTime = high_resolution_clock::now();
+        for (int i=0; i<iConsumers; ++i) consumer(q, totals);    //Each runs to its first co_await.
+        cout << iConsumers << " consumer coroutines on " << iWorkers << " worker threads, "
+             << -q.getBalance() << " suspended" << endl;
+
+        vector<thread> vecProducers;
+        for (int p=0; p<iProducers; ++p)
+        {
+            vecProducers.emplace_back([&]() { for (lli i=0; i<iItems; ++i) q.push(i); });
+        }
+        for (auto& t : vecProducers) t.join();
+        for (int i=0; i<iConsumers; ++i) q.push(-1);
+        while (totals.m_iFinished.load(memory_order_acquire) < iConsumers) this_thread::yield();
+        dSec = duration_cast<microseconds>(high_resolution_clock::now() - startTime).count() / 1e6;
+
+        lli iExpCount = iItems * iProducers, iExpSum = iProducers * (iItems * (iItems - 1) / 2);
+        bOk = (totals.m_iCount == iExpCount) && (totals.m_iSum == iExpSum) && (0 == q.getBalance());
+        cout << "Received " << totals.m_iCount << " / " << iExpCount << " items in " << dSec << " s, "
+             << iExpCount / dSec / 1e6 << " Mops/s -> " << (bOk ? "OK" : "FAILED") << endl;
+    }
+    bOk = runSteady(iSteadyItems, iWorkers) && bOk;
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#ifndef QUEUE_ASYNC_QUEUE_H
+#define QUEUE_ASYNC_QUEUE_H
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+#include "LockFreeQueue.h"
+
+
+/*
+Awaitable MPMC queue for C++20 coroutines on top of LockFreeQueue.
+
+    T v = co_await q.pop();     suspends the coroutine (not the thread) while q is empty
+    q.push(v);                  any thread, resumes one suspended pop if there is one
+
+Items and suspended pops are both kept in a LockFreeQueue, one signed balance counter
+decides which side an operation takes:
+    balance = queued items - suspended pops
+    push : balance++ , was < 0  -> take the oldest waiter, hand v to it directly, resume it
+                       else     -> enqueue v
+    pop  : balance-- , was > 0  -> an item is reserved for us, dequeue it, no suspension
+                       else     -> enqueue ourselves as waiter and suspend
+The waiter list is a LockFreeQueue of pointers into the suspended coroutine frames, so
+waiters are served FIFO and a waiting consumer costs one list node, no OS thread.
+Both lists free their nodes as they go (LockFreeQueue's epochs), memory follows the backlog,
+not the number of items pushed so far.
+Between the counter update and the matching enqueue of the other side there is a window
+of a few instructions, the side that arrives first spins (yielding) through it.
+
+Where the resumed coroutine runs is up to the Resumer: by default inline on the pushing
+thread, pass a function that hands the handle to an executor to keep producers short and
+run thousands of consumers on a few worker threads.
+*/
+
+template<typename T>
+class AsyncQueue
+{
+    public:
+    typedef void (*Resumer)(std::coroutine_handle<> handle, void* pContext);
+
+    private:
+        struct Waiter
+        {
+            std::coroutine_handle<> m_handle;
+            T m_value;
+        };
+
+        LockFreeQueue<T> m_items;
+        LockFreeQueue<Waiter*> m_waiters;
+        alignas(64) std::atomic<long long> m_iBalance;
+        Resumer m_pfnResume;
+        void* m_pContext;
+
+        static void resumeInline(std::coroutine_handle<> handle, void*) { handle.resume(); }
+
+        template<typename Q, typename V>
+        static inline void dequeueReserved(Q& q, V& value)
+        {
+            while (!q.dequeue(value)) std::this_thread::yield();
+        }
+
+    public:
+    class PopAwaiter
+    {
+        private:
+            AsyncQueue& m_q;
+            Waiter m_waiter;
+
+        public:
+        explicit PopAwaiter(AsyncQueue& q) : m_q(q), m_waiter{} {}
+
+        bool await_ready()
+        {
+            if (m_q.m_iBalance.fetch_sub(1, std::memory_order_acq_rel) > 0)
+            {
+                dequeueReserved(m_q.m_items, m_waiter.m_value);
+                return true;
+            }
+            return false;
+        }
+
+        //Nothing may touch this awaiter after the enqueue, a producer can resume us at once.
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_waiter.m_handle = handle;
+            m_q.m_waiters.enqueue(&m_waiter);
+        }
+
+        T await_resume() { return std::move(m_waiter.m_value); }
+    };
+
+    explicit AsyncQueue(Resumer pfnResume = resumeInline, void* pContext = NULL)
+        : m_iBalance{0}, m_pfnResume{pfnResume}, m_pContext{pContext} {}
+    AsyncQueue(const AsyncQueue&) = delete;
+    AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+    void push(const T& value)
+    {
+        if (m_iBalance.fetch_add(1, std::memory_order_acq_rel) < 0)
+        {
+            Waiter* pWaiter;
+            dequeueReserved(m_waiters, pWaiter);
+            pWaiter->m_value = value;
+            m_pfnResume(pWaiter->m_handle, m_pContext);
+            return;
+        }
+        m_items.enqueue(value);
+    }
+
+    PopAwaiter pop() { return PopAwaiter(*this); }
+
+    //Non suspending pop, false when no item is available right now.
+    bool tryPop(T& result)
+    {
+        long long iBalance = m_iBalance.load(std::memory_order_relaxed);
+        while (iBalance > 0)
+        {
+            if (m_iBalance.compare_exchange_weak(iBalance, iBalance - 1, std::memory_order_acq_rel))
+            {
+                dequeueReserved(m_items, result);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Items queued (> 0) or coroutines waiting (< 0), a snapshot.
+    inline long long getBalance() const { return m_iBalance.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include <bits/stdc++.h>
+#include "../Utils/PerfCounter.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+False sharing microbenchmark for the per thread reclamation state.
+Runs the access pattern of HazardPointers (LockFreeQ.h) and EpochManager (LockFreeQueue.h)
+over the old and the new layouts with 1 .. 32+ threads. The structs and the operations below
+mirror the shipped ones, keep them in step when those change.
+
+Hazard pointers (32 threads max), per op as in LockFreeQ::dequeue: protect 2 slots (relaxed
+store + seq_cst fence each), unprotect 2 slots (release stores), retire 1 node. Every
+RETIRE_THRESHOLD (128) retires one fence and an is_Protected scan of all 32 x 2 slots per
+retired node.
+    packed       2 slots per thread back to back, 4 threads per line     (false sharing)
+    per-slot     alignas(64) per slot, old HazardRecord, 2 lines per thread
+    per-thread   alignas(64) per thread with both slots, shipped HazardRecord
+
+Epoch (64 threads max), per op as in LockFreeQueue::dequeue: enter (pin with a seq_cst fence),
+retire 1 node into the bucket of its epoch, exit (unpin). Every RECLAIM_FREQ (64) retires
+try_advance scans all 64 local epochs and moves the global epoch on, expired buckets are
+cleared (nodes are not really freed, so malloc stays out of the numbers).
+    mixed        local_epoch on the line the owner's op_count / retired buckets live on,
+                 old ThreadData
+    split        local_epoch alone on its line (SharedState), owner only data on another
+                 (PrivateState), shipped layout
+
+Without false sharing ns/op stays flat as threads are added (until cores run out),
+LLC misses per op show the line transfers where the PMU is available.
+
+Compile: g++ -O3 -std=c++17 -pthread FalseSharingBench.cpp
+Run    : ./a.out [max threads (default max(32, cores))] [ops per thread]
+*/
+
+const int MAX_THREADS = 64;
+
+//HazardPointers (LockFreeQ.h)
+const int HAZARD_THREADS = 32;
+const int HAZARDS = 2;
+const int RETIRE_THRESHOLD = HAZARD_THREADS * HAZARDS * 2;
+
+struct PackedHazards { atomic<void*> m_ptr[HAZARDS]; };
+struct alignas(64) SlotHazard { atomic<void*> m_ptr; };
+struct alignas(64) ThreadHazards { atomic<void*> m_ptr[HAZARDS]; };     //HazardRecord.
+
+PackedHazards g_packed[HAZARD_THREADS];
+SlotHazard g_perSlot[HAZARD_THREADS][HAZARDS];
+ThreadHazards g_perThread[HAZARD_THREADS];
+
+inline atomic<void*>& slot(PackedHazards* p, int t, int h)  { return p[t].m_ptr[h]; }
+inline atomic<void*>& slot(SlotHazard (*p)[HAZARDS], int t, int h) { return p[t][h].m_ptr; }
+inline atomic<void*>& slot(ThreadHazards* p, int t, int h) { return p[t].m_ptr[h]; }
+
+template<typename Layout>
+lli hazardWorker(Layout layout, int iThread, lli iOps)
+{
+    lli iFound = 0;
+    void* pNode = &iFound;
+    int iRetired = 0;
+    for (lli i=0; i<iOps; ++i)
+    {
+        for (int h=0; h<HAZARDS; ++h)
+        {
+            slot(layout, iThread, h).store(pNode, memory_order_relaxed);      //protect
+            atomic_thread_fence(memory_order_seq_cst);
+        }
+        for (int h=0; h<HAZARDS; ++h) slot(layout, iThread, h).store(nullptr, memory_order_release);
+        if (++iRetired < RETIRE_THRESHOLD) continue;
+
+        //scan_And_Delete_Retired_Nodes, one is_Protected per retired node.
+        atomic_thread_fence(memory_order_seq_cst);
+        for (; iRetired > 0; --iRetired)
+        {
+            for (int t=0; t<HAZARD_THREADS; ++t)
+            {
+                for (int h=0; h<HAZARDS; ++h) iFound += (slot(layout, t, h).load(memory_order_acquire) == pNode);
+            }
+        }
+    }
+    return iFound;
+}
+
+//EpochManager (LockFreeQueue.h)
+const size_t RECLAIM_FREQ = 64;
+const size_t BUCKETS = 4;
+const uint64_t SAFE_DISTANCE = 3;
+const uint64_t UNPINNED = UINT64_MAX;
+
+struct alignas(64) MixedEpoch
+{
+    atomic<uint64_t> m_iLocalEpoch{UNPINNED};
+    uint64_t m_iOpCount{0};
+    vector<void*> m_retired[BUCKETS];
+    uint64_t m_iRetiredEpoch[BUCKETS]{};
+};
+struct alignas(64) SharedEpoch                  //SharedState.
+{
+    atomic<uint64_t> m_iLocalEpoch{UNPINNED};
+};
+struct alignas(64) PrivateEpoch                 //PrivateState.
+{
+    uint64_t m_iOpCount{0};
+    vector<void*> m_retired[BUCKETS];
+    uint64_t m_iRetiredEpoch[BUCKETS]{};
+};
+
+alignas(64) atomic<uint64_t> g_iGlobalEpoch{0};
+MixedEpoch g_mixed[MAX_THREADS];
+SharedEpoch g_shared[MAX_THREADS];
+PrivateEpoch g_private[MAX_THREADS];
+
+template<typename Shared, typename Private>
+lli epochWorker(Shared* pShared, Private* pPrivate, int iThread, lli iOps)
+{
+    lli iAdvanced = 0;
+    Shared& ss = pShared[iThread];
+    Private& ps = pPrivate[iThread];
+    for (lli i=0; i<iOps; ++i)
+    {
+        //enter
+        uint64_t ge = g_iGlobalEpoch.load(memory_order_acquire);
+        while (true)
+        {
+            ss.m_iLocalEpoch.store(ge, memory_order_release);
+            atomic_thread_fence(memory_order_seq_cst);
+            uint64_t iNow = g_iGlobalEpoch.load(memory_order_acquire);
+            if (iNow == ge) break;
+            ge = iNow;
+        }
+
+        //retire
+        uint64_t iEpoch = ss.m_iLocalEpoch.load(memory_order_relaxed);
+        size_t b = iEpoch % BUCKETS;
+        if (ps.m_iRetiredEpoch[b] != iEpoch)
+        {
+            ps.m_retired[b].clear();
+            ps.m_iRetiredEpoch[b] = iEpoch;
+        }
+        ps.m_retired[b].push_back(&iAdvanced);
+        if (0 == ++ps.m_iOpCount % RECLAIM_FREQ)
+        {
+            //try_advance
+            ge = g_iGlobalEpoch.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            bool bAll = true;
+            for (int t=0; t<MAX_THREADS && bAll; ++t)
+            {
+                uint64_t le = pShared[t].m_iLocalEpoch.load(memory_order_acquire);
+                bAll = (le == UNPINNED || le == ge);
+            }
+            if (bAll) iAdvanced += g_iGlobalEpoch.compare_exchange_strong(ge, ge + 1, memory_order_acq_rel,
+                                                                          memory_order_relaxed);
+            ge = g_iGlobalEpoch.load(memory_order_acquire);
+            for (size_t k=0; k<BUCKETS; ++k)
+            {
+                if (!ps.m_retired[k].empty() && ps.m_iRetiredEpoch[k] + SAFE_DISTANCE <= ge) ps.m_retired[k].clear();
+            }
+        }
+
+        //exit
+        ss.m_iLocalEpoch.store(UNPINNED, memory_order_release);
+    }
+    return iAdvanced;
+}
+
+struct Result
+{
+    double m_dNsPerOp;
+    PerfSample m_sample;
+};
+
+//Wall time per op of one thread (all threads run in parallel).
+Result runThreads(PerfCounters& counters, int iThreads, lli iOps, function<lli(int)> fnWorker)
+{
+    atomic<lli> iSink{0};
+    atomic<int> iReady{0};
+    atomic<bool> bGo{false};
+    Result result;
+    vector<thread> vecThreads;
+    for (int t=0; t<iThreads; ++t)
+    {
+        vecThreads.emplace_back([&, t]()
+        {
+            iReady.fetch_add(1);
+            while (!bGo.load(memory_order_acquire)) this_thread::yield();
+            iSink.fetch_add(fnWorker(t));
+        });
+    }
+    while (iReady.load() < iThreads) this_thread::yield();
+    auto startTime = high_resolution_clock::now();
+    counters.start();
+    bGo.store(true, memory_order_release);
+    for (auto& t : vecThreads) t.join();
+    counters.stop(result.m_sample);
+    double dSec = duration_cast<nanoseconds>(high_resolution_clock::now() - startTime).count() / 1e9;
+    result.m_dNsPerOp = dSec * 1e9 / iOps;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int iCores = max(1u, thread::hardware_concurrency());
+    int iMaxThreads = min(MAX_THREADS, (argc > 1) ? atoi(argv[1]) : max(32, iCores));
+    lli iOps = (argc > 2) ? atoll(argv[2]) : 2'000'000;
+    PerfCounters counters;
+
+    vector<int> vecThreads;
+    for (int t=1; t<iMaxThreads; t*=2) vecThreads.push_back(t);
+    vecThreads.push_back(iMaxThreads);
+
+    //Name, thread slots of the scheme, worker.
+    vector<tuple<string, int, function<lli(int)>>> vecCases = {
+        {"hazard packed",     HAZARD_THREADS, [&](int t) { return hazardWorker(g_packed, t, iOps); }},
+        {"hazard per-slot",   HAZARD_THREADS, [&](int t) { return hazardWorker(g_perSlot, t, iOps); }},
+        {"hazard per-thread", HAZARD_THREADS, [&](int t) { return hazardWorker(g_perThread, t, iOps); }},
+        {"epoch mixed",       MAX_THREADS,    [&](int t) { return epochWorker(g_mixed, g_mixed, t, iOps); }},
+        {"epoch split",       MAX_THREADS,    [&](int t) { return epochWorker(g_shared, g_private, t, iOps); }},
+    };
+
+    cout << "False sharing, " << iOps << " ops per thread, " << iCores << " cores\n";
+    if (!counters.status().empty()) cout << "Note: " << counters.status() << "\n";
+    cout << fixed << setprecision(2);
+    cout << setw(20) << "Layout" << setw(9) << "Threads" << setw(12) << "ns/op";
+    PerfSample::printHeader(cout);
+    cout << "\n" << string(86, '-') << "\n";
+    for (auto& testCase : vecCases)
+    {
+        for (int iThreads : vecThreads)
+        {
+            if (iThreads > get<1>(testCase)) continue;
+            Result result = runThreads(counters, iThreads, iOps, get<2>(testCase));
+            cout << setw(20) << get<0>(testCase) << setw(9) << iThreads << setw(12) << result.m_dNsPerOp;
+            result.m_sample.print(cout, (double)iOps * iThreads);
+            cout << "\n";
+        }
+        cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,293 @@
+#ifndef QUEUE_LOCK_FREE_Q_H
+#define QUEUE_LOCK_FREE_Q_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "ThreadSlots.h"
+
+
+/*
+Michael & Scott lock-free MPMC queue with hazard pointer reclamation, values are heap
+allocated and owned by the nodes. Workload & check in Lock_Free_Q_v1_.cpp, QueueStress.cpp.
+*/
+
+/*
+Memory ordering of LockFreeQ & HazardPointers.
+Default is the minimal ordering: acquire loads of head / tail / next, release CAS to publish
+a node, relaxed hazard stores with one seq_cst fence after publishing a hazard (protect) and
+one before scanning the hazards (scan_And_Delete_Retired_Nodes). Those two fences are the
+store -> load ordering hazard pointers need: either the scanner sees the hazard or the reader's
+re-check sees the node already unlinked.
+Compile with -DLFQ_SEQ_CST to make every operation seq_cst again (the original code, the
+fences are then implied by the seq_cst stores & loads), main prints time & counters of both:
+    g++ -O3 -std=c++17 -pthread Lock_Free_Q_v1_.cpp
+    g++ -O3 -std=c++17 -pthread -DLFQ_SEQ_CST Lock_Free_Q_v1_.cpp
+Lock_Free_Q_v1_.cpp's main also checks the sum of everything dequeued and that nothing is left.
+*/
+#ifdef LFQ_SEQ_CST
+const std::memory_order MO_RELAXED = std::memory_order_seq_cst;
+const std::memory_order MO_ACQUIRE = std::memory_order_seq_cst;
+const std::memory_order MO_RELEASE = std::memory_order_seq_cst;
+const std::memory_order MO_ACQ_REL = std::memory_order_seq_cst;
+const char* const MO_NAME = "seq_cst everywhere";
+inline void hazardFence() {}
+#else
+const std::memory_order MO_RELAXED = std::memory_order_relaxed;
+const std::memory_order MO_ACQUIRE = std::memory_order_acquire;
+const std::memory_order MO_RELEASE = std::memory_order_release;
+const std::memory_order MO_ACQ_REL = std::memory_order_acq_rel;
+const char* const MO_NAME = "minimal (acquire / release + hazard fences)";
+inline void hazardFence() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+#endif
+
+template<typename T>
+class HazardPointers
+{
+    private:
+    static constexpr size_t MAX_THREADS = 32;
+    static constexpr size_t HAZARD_PER_THREAD = 2;
+    static constexpr size_t RETIRE_THRESHOLD = MAX_THREADS * HAZARD_PER_THREAD * 2;
+    /*
+    All hazard slots of one thread share one cache line (alignas(64) pads the rest), a thread
+    writes only its own line and no other thread's slot sits on it, so protect / unprotect
+    never invalidate another core's line. is_Protected reads MAX_THREADS lines instead of
+    MAX_THREADS * HAZARD_PER_THREAD.
+    */
+    struct alignas(64) HazardRecord 
+    {
+        std::atomic<T*> m_ptr[HAZARD_PER_THREAD];
+        HazardRecord() { for (auto& ptr : m_ptr) ptr.store(NULL, std::memory_order_relaxed); }
+    };
+    static_assert(sizeof(HazardRecord) == 64, "One cache line per thread");
+    static HazardRecord _arr_Hazards[MAX_THREADS];    
+    static thread_local std::vector<T*> vec_Retired_List;
+
+    //Own slot while the thread lives, reused after it exits (ThreadSlots.h), so live threads never share hazards.
+    static size_t getThreadID() { return ThreadSlots<MAX_THREADS>::get(); }
+    static void scan_And_Delete_Retired_Nodes ()
+    {
+        if (vec_Retired_List.empty()) {
+            return;
+        }
+        //Pairs with the fence in protect, the unlink of every retired node is ordered before the hazard loads.
+        hazardFence();
+        std::vector<T*> vec_Remaining_Nodes;
+
+        for (T* ptr:vec_Retired_List)
+        {
+            if (!is_Protected(ptr)) {
+                delete ptr; ptr = NULL;
+            }
+            else {
+                vec_Remaining_Nodes.push_back(ptr);
+            }
+        }
+        vec_Retired_List.swap(vec_Remaining_Nodes);
+    }
+    
+    public:
+    ~HazardPointers ()
+    {
+        for (T* ptr:vec_Retired_List)
+        {
+            delete ptr; ptr = NULL;
+        }
+    }
+    static void protect(size_t index, T *ptr)
+    {
+        size_t t_ID = getThreadID();
+        _arr_Hazards[t_ID].m_ptr[index].store(ptr, MO_RELAXED);
+        //Hazard must be visible before the caller re-reads the source pointer (store -> load).
+        hazardFence();
+    }
+
+    static void unprotect(size_t index)
+    {
+        size_t t_ID = getThreadID();
+        _arr_Hazards[t_ID].m_ptr[index].store(NULL, MO_RELEASE);   //After our last read of the node.
+    }
+
+    static bool is_Protected(T *ptr)
+    {
+        for (size_t i=0; i<MAX_THREADS; ++i) {
+            for (size_t j=0; j<HAZARD_PER_THREAD; ++j) {
+                if (_arr_Hazards[i].m_ptr[j].load(MO_ACQUIRE) == ptr) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static bool retire_Node(T *ptr)
+    {
+        if (NULL == ptr) {
+            return false;
+        }
+        vec_Retired_List.push_back(ptr);
+
+        if (vec_Retired_List.size() >= RETIRE_THRESHOLD)
+        {
+            scan_And_Delete_Retired_Nodes();
+        }
+        return true;
+    }
+
+};
+
+//Static Member function definitions.
+template<typename T>
+typename HazardPointers<T>::HazardRecord HazardPointers<T>::_arr_Hazards[HazardPointers<T>::MAX_THREADS];
+template<typename T>
+thread_local std::vector<T*> HazardPointers<T>::vec_Retired_List;
+// template<typename T>
+// constexpr size_t HazardPointers<T>::MAX_THREADS{16};
+// template<typename T>
+// constexpr size_t HazardPointers<T>::HAZARD_PER_THREAD{2};
+// template<typename T>
+// constexpr size_t HazardPointers<T>::RETIRE_THRESHOLD{HazardPointers<T>::MAX_THREADS * HazardPointers<T>::HAZARD_PER_THREAD * 2};
+///
+
+
+template <typename T>
+class LockFreeQ
+{
+    private:
+    struct Node
+    {
+        std::atomic<T*> data;
+        std::atomic<Node*> next;
+        
+        Node () : data{NULL}, next{NULL} {}
+        Node (T* pData) : data{pData}, next{NULL} {}
+        Node (T* pData, Node *pNext) : data{pData}, next{pNext} {}
+    };
+
+    std::atomic<Node *> m_head;
+    std::atomic<Node *> m_tail;
+    using HazardPtr = HazardPointers<Node>;
+
+    public:
+
+    LockFreeQ ()
+    {
+        Node* dummy = new Node();
+        m_head.store(dummy, MO_RELAXED);
+        m_tail.store(dummy, MO_RELAXED);
+    }
+    ~LockFreeQ ()
+    {
+        Node *pCrntNode = m_head.load(MO_RELAXED);
+        while (pCrntNode)
+        {
+            Node *pNext = pCrntNode->next.load(MO_RELAXED);
+            T* pData = pCrntNode->data.load(MO_RELAXED);
+            delete pData; pData = NULL;
+            delete pCrntNode;
+            pCrntNode = pNext;
+        }
+    }
+    LockFreeQ (const LockFreeQ&) = delete;
+    LockFreeQ& operator= (const LockFreeQ&) = delete;
+    
+    bool enqueue (T data)
+    {
+        Node *pNode = new Node();
+        T* pData = new T(std::move(data));
+        pNode->data.store(pData, MO_RELAXED);      //Published by the release CAS on next.
+        while (true)
+        {
+            Node *pLast = m_tail.load(MO_ACQUIRE);
+            HazardPtr::protect(0, pLast);
+            if (m_tail.load(MO_ACQUIRE) != pLast)
+            {
+                HazardPtr::unprotect(0);
+                continue;
+            }
+            Node *pNext = pLast->next.load(MO_ACQUIRE);
+            if (m_tail.load(MO_ACQUIRE) == pLast)
+            {
+                if (NULL == pNext)
+                {
+                    if (pLast->next.compare_exchange_weak(pNext, pNode, MO_RELEASE, MO_ACQUIRE))
+                    {
+                        m_tail.compare_exchange_weak(pLast, pNode, MO_RELEASE, MO_RELAXED);
+                        HazardPtr::unprotect(0);
+                        return true;
+                    }
+                }
+                else {
+                    m_tail.compare_exchange_weak(pLast, pNext, MO_RELEASE, MO_RELAXED);
+                }
+            }
+            HazardPtr::unprotect(0);
+        } 
+        return false;
+    }
+
+    bool dequeue (T &returnValue)
+    {
+        while (true)
+        {
+            Node *pFirst = m_head.load(MO_ACQUIRE);
+            HazardPtr::protect(0, pFirst);
+            if (m_head.load(MO_ACQUIRE) != pFirst)
+            {
+                HazardPtr::unprotect(0);
+                continue;
+            }
+            Node *pLast = m_tail.load(MO_ACQUIRE);
+            Node *pNext = pFirst->next.load(MO_ACQUIRE);
+            HazardPtr::protect(1, pNext);
+            if (m_head.load(MO_ACQUIRE) != pFirst)
+            {
+                HazardPtr::unprotect(0);
+                HazardPtr::unprotect(1);
+                continue;
+            }
+            if (pFirst == pLast)
+            {
+                if (NULL == pNext)
+                {
+                    HazardPtr::unprotect(0);
+                    HazardPtr::unprotect(1);
+                    return false;
+                }
+                m_tail.compare_exchange_weak(pLast, pNext, MO_RELEASE, MO_RELAXED);
+            }
+            else
+            {
+                if (NULL == pNext)
+                {
+                    HazardPtr::unprotect(0);
+                    HazardPtr::unprotect(1);
+                    continue;
+                }
+                T* data = pNext->data.load(MO_ACQUIRE);
+                if (NULL == data)
+                {
+                    HazardPtr::unprotect(0);
+                    HazardPtr::unprotect(1);
+                    continue;    
+                }
+                if (m_head.compare_exchange_weak(pFirst, pNext, MO_ACQ_REL, MO_RELAXED))
+                {
+                    returnValue = *data;
+                    delete data;
+                    pNext->data.store(NULL, MO_RELAXED);   //pNext is the new dummy, only we own data.
+                    HazardPtr::unprotect(0);
+                    HazardPtr::unprotect(1);
+                    HazardPtr::retire_Node(pFirst);
+                    return true;
+                }                                
+            }
+            HazardPtr::unprotect(0);
+            HazardPtr::unprotect(1);
+        }
+    }
+
+};
+
+#endif
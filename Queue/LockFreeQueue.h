@@ -0,0 +1,284 @@
+#ifndef QUEUE_LOCK_FREE_QUEUE_H
+#define QUEUE_LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ThreadSlots.h"
+
+
+/*
+Michael & Scott lock-free MPMC queue with epoch based reclamation.
+Used by the Play.cpp benchmark, as the lanes of LevelPriorityQueue and under AsyncQueue.
+*/
+
+// ============================================================================
+// EPOCH-BASED RECLAMATION (Much faster than Hazard Pointers!)
+// ============================================================================
+
+/*
+Threads pin the queue's epoch for the length of one operation (enter / exit). An unlinked node
+is retired with the epoch its thread is pinned at and freed once the global epoch is 3 past
+it: the epoch only advances when every pinned thread has seen the current one, so by then
+no thread can still hold a pointer read before the unlink. Every RECLAIM_FREQ retires a
+thread tries to advance the epoch and frees its expired buckets, so memory stays bounded by
+a few epochs of retired nodes per thread (as long as no thread stalls while pinned).
+*/
+template<typename T>
+class EpochManager
+{
+private:
+    static constexpr size_t MAX_THREADS = 64;
+    static constexpr size_t RECLAIM_FREQ = 64;  // Retires between advance & free attempts
+    static constexpr size_t BUCKETS = 4;        // Epochs a thread can have unexpired nodes in
+    static constexpr uint64_t SAFE_DISTANCE = 3;
+    static constexpr uint64_t UNPINNED = UINT64_MAX;
+    
+    // Written by the owner on every enter/exit, read by every thread's
+    // try_advance: one line per thread and nothing else on it
+    struct alignas(64) SharedState
+    {
+        std::atomic<uint64_t> local_epoch{UNPINNED};
+    };
+    
+    // Owner only. op_count and the vectors' end pointers change on every retire,
+    // on the shared line they would invalidate it for all scanning threads
+    struct alignas(64) PrivateState
+    {
+        uint64_t op_count{0};
+        std::vector<T*> retired[BUCKETS];   // Bucket e % BUCKETS
+        uint64_t retired_epoch[BUCKETS]{};  // Epoch the bucket's nodes were retired in
+    };
+    
+    // Per queue: retired nodes belong to the queue that unlinked them, so one
+    // queue's destructor never frees (or forgets) another live queue's nodes
+    alignas(64) std::atomic<uint64_t> global_epoch{0};
+    SharedState shared_state[MAX_THREADS];
+    PrivateState private_state[MAX_THREADS];
+    
+    // Slot of the calling thread, released when it exits (Queue/ThreadSlots.h)
+    static size_t get_thread_id() { return ThreadSlots<MAX_THREADS>::get(); }
+    
+    static void free_bucket(std::vector<T*>& bucket)
+    {
+        for (T* p : bucket)
+            delete p;
+        bucket.clear();
+    }
+    
+    // Moves the global epoch on by one if every pinned thread is in it
+    void try_advance()
+    {
+        uint64_t ge = global_epoch.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // Pairs with the fence in enter
+        
+        // Acquire loads of the owners' release stores & the acq_rel CAS make every access
+        // of an operation that ended before the advance happen before the eventual delete
+        for (size_t i = 0; i < MAX_THREADS; ++i)
+        {
+            uint64_t le = shared_state[i].local_epoch.load(std::memory_order_acquire);
+            if (le != UNPINNED && le != ge)
+                return;
+        }
+        
+        global_epoch.compare_exchange_strong(ge, ge + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+    
+public:
+    EpochManager() = default;
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+    
+    /*
+    Pins the current epoch. The fence orders the pin before every node load of the
+    operation: either try_advance sees the pin or we see the epoch it moved to, then
+    pin again so the published epoch is never older than the one we run in.
+    */
+    void enter()
+    {
+        SharedState& ss = shared_state[get_thread_id()];
+        uint64_t ge = global_epoch.load(std::memory_order_acquire);
+        
+        while (true)
+        {
+            ss.local_epoch.store(ge, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t now = global_epoch.load(std::memory_order_acquire);
+            if (now == ge)
+                return;
+            ge = now;
+        }
+    }
+    
+    void exit()
+    {
+        shared_state[get_thread_id()].local_epoch.store(UNPINNED, std::memory_order_release);
+    }
+    
+    // Caller is pinned (between enter and exit) and has unlinked ptr
+    void retire(T* ptr)
+    {
+        if (!ptr) return;
+        
+        size_t tid = get_thread_id();
+        PrivateState& ps = private_state[tid];
+        uint64_t epoch = shared_state[tid].local_epoch.load(std::memory_order_relaxed);
+        
+        // A thread's pinned epochs never go back, an older tenant of the bucket is expired
+        size_t b = epoch % BUCKETS;
+        if (ps.retired_epoch[b] != epoch)
+        {
+            free_bucket(ps.retired[b]);
+            ps.retired_epoch[b] = epoch;
+        }
+        ps.retired[b].push_back(ptr);
+        
+        if (++ps.op_count % RECLAIM_FREQ == 0)
+        {
+            try_advance();
+            uint64_t ge = global_epoch.load(std::memory_order_acquire);
+            for (size_t i = 0; i < BUCKETS; ++i)
+            {
+                if (!ps.retired[i].empty() && ps.retired_epoch[i] + SAFE_DISTANCE <= ge)
+                    free_bucket(ps.retired[i]);
+            }
+        }
+    }
+    
+    ~EpochManager()
+    {
+        // Cleanup this queue's retired nodes, no thread is inside it any more
+        for (size_t i = 0; i < MAX_THREADS; ++i)
+        {
+            for (size_t b = 0; b < BUCKETS; ++b)
+                free_bucket(private_state[i].retired[b]);
+        }
+    }
+};
+
+// ============================================================================
+// LOCK-FREE QUEUE WITH EPOCH-BASED RECLAMATION
+// ============================================================================
+
+template <typename T>
+class LockFreeQueue
+{
+private:
+    struct Node
+    {
+        T data;
+        std::atomic<Node*> next;
+        
+        Node() : data{}, next{nullptr} {}
+        explicit Node(const T& val) : data(val), next{nullptr} {}
+    };
+
+    alignas(64) std::atomic<Node*> m_head;
+    alignas(64) std::atomic<Node*> m_tail;
+    EpochManager<Node> epoch_mgr;
+
+public:
+    LockFreeQueue()
+    {
+        Node* dummy = new Node();
+        m_head.store(dummy, std::memory_order_relaxed);
+        m_tail.store(dummy, std::memory_order_relaxed);
+    }
+    
+    ~LockFreeQueue()
+    {
+        Node* current = m_head.load(std::memory_order_relaxed);
+        while (current)
+        {
+            Node* next = current->next.load(std::memory_order_relaxed);
+            delete current;
+            current = next;
+        }
+    }
+    
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+    
+    bool enqueue(const T& value)
+    {
+        epoch_mgr.enter();
+        
+        Node* newNode = new Node(value);
+        
+        while (true)
+        {
+            Node* tail = m_tail.load(std::memory_order_acquire);
+            Node* next = tail->next.load(std::memory_order_acquire);
+            
+            if (tail == m_tail.load(std::memory_order_acquire))
+            {
+                if (next == nullptr)
+                {
+                    if (tail->next.compare_exchange_weak(next, newNode,
+                                                         std::memory_order_release,
+                                                         std::memory_order_acquire))
+                    {
+                        m_tail.compare_exchange_weak(tail, newNode,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed);
+                        epoch_mgr.exit();
+                        return true;
+                    }
+                }
+                else
+                {
+                    m_tail.compare_exchange_weak(tail, next,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    bool dequeue(T& result)
+    {
+        epoch_mgr.enter();
+        
+        while (true)
+        {
+            Node* head = m_head.load(std::memory_order_acquire);
+            Node* tail = m_tail.load(std::memory_order_acquire);
+            Node* next = head->next.load(std::memory_order_acquire);
+            
+            if (head == m_head.load(std::memory_order_acquire))
+            {
+                if (head == tail)
+                {
+                    if (next == nullptr)
+                    {
+                        epoch_mgr.exit();
+                        return false;
+                    }
+                    
+                    m_tail.compare_exchange_weak(tail, next,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed);
+                }
+                else
+                {
+                    if (next == nullptr)
+                        continue;
+                    
+                    result = next->data;
+                    
+                    if (m_head.compare_exchange_weak(head, next,
+                                                     std::memory_order_release,
+                                                     std::memory_order_acquire))
+                    {
+                        epoch_mgr.retire(head);
+                        epoch_mgr.exit();
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif
@@ -1,4 +1,7 @@
 #include <bits/stdc++.h>
+#include "../Utils/PerfCounter.h"
+#include "../Utils/BatchCounter.h"
+#include "LockFreeQ.h"
 using namespace std;
 typedef long long int lli;
 typedef unsigned long long ull;
@@ -6,257 +9,6 @@ using  namespace std::chrono;
 #define MAX_TESTS 10000000
 #define MAX_T_CNT 4
 
-template<typename T>
-class HazardPointers
-{
-    private:
-    static constexpr size_t MAX_THREADS = 8;
-    static constexpr size_t HAZARD_PER_THREAD = 2;
-    static constexpr size_t RETIRE_THRESHOLD = MAX_THREADS * HAZARD_PER_THREAD * 2;
-    struct alignas(64) HazardRecord 
-    {
-        std::atomic<T*> m_ptr;
-        //char cPadding[64 - sizeof(std::atomic<T*>)]; //To avoid false sharing between multiple cores of cache.
-        HazardRecord(): m_ptr{NULL} {}
-    };
-    static HazardRecord _arr_Hazards[MAX_THREADS][HAZARD_PER_THREAD];    
-    static thread_local size_t __thread_ID;
-    static std::atomic<size_t> g_thread_Counter;
-    static thread_local std::vector<T*> vec_Retired_List;
-
-    static size_t getThreadID()
-    {
-        static thread_local bool initialized = false;
-        if (!initialized)
-        {
-            __thread_ID = g_thread_Counter.fetch_add(1) % MAX_THREADS;
-            initialized = true;
-        }
-        return __thread_ID;
-    }
-    static void scan_And_Delete_Retired_Nodes ()
-    {
-        if (vec_Retired_List.empty()) {
-            return;
-        }
-        std::vector<T*> vec_Remaining_Nodes;
-
-        for (T* ptr:vec_Retired_List)
-        {
-            if (!is_Protected(ptr)) {
-                delete ptr; ptr = NULL;
-            }
-            else {
-                vec_Remaining_Nodes.push_back(ptr);
-            }
-        }
-        vec_Retired_List.swap(vec_Remaining_Nodes);
-    }
-    
-    public:
-    ~HazardPointers ()
-    {
-        for (T* ptr:vec_Retired_List)
-        {
-            delete ptr; ptr = NULL;
-        }
-    }
-    static void protect(size_t index, T *ptr)
-    {
-        size_t t_ID = getThreadID();
-        _arr_Hazards[t_ID][index].m_ptr.store(ptr);
-    }
-
-    static void unprotect(size_t index)
-    {
-        size_t t_ID = getThreadID();
-        _arr_Hazards[t_ID][index].m_ptr.store(NULL);
-    }
-
-    static bool is_Protected(T *ptr)
-    {
-        for (size_t i=0; i<MAX_THREADS; ++i) {
-            for (size_t j=0; j<HAZARD_PER_THREAD; ++j) {
-                if (_arr_Hazards[i][j].m_ptr.load() == ptr) {
-                    return true;
-                }
-            }
-        }
-        return false;
-    }
-
-    static bool retire_Node(T *ptr)
-    {
-        if (NULL == ptr) {
-            return false;
-        }
-        vec_Retired_List.push_back(ptr);
-
-        if (vec_Retired_List.size() >= RETIRE_THRESHOLD)
-        {
-            scan_And_Delete_Retired_Nodes();
-        }
-        return true;
-    }
-
-};
-
-//Static Member function definitions.
-template<typename T>
-typename HazardPointers<T>::HazardRecord HazardPointers<T>::_arr_Hazards[HazardPointers<T>::MAX_THREADS][HazardPointers<T>::HAZARD_PER_THREAD];
-template<typename T>
-thread_local size_t HazardPointers<T>::__thread_ID{0};
-template<typename T>
-std::atomic<size_t> HazardPointers<T>::g_thread_Counter{0};
-template<typename T>
-thread_local std::vector<T*> HazardPointers<T>::vec_Retired_List;
-// template<typename T>
-// constexpr size_t HazardPointers<T>::MAX_THREADS{16};
-// template<typename T>
-// constexpr size_t HazardPointers<T>::HAZARD_PER_THREAD{2};
-// template<typename T>
-// constexpr size_t HazardPointers<T>::RETIRE_THRESHOLD{HazardPointers<T>::MAX_THREADS * HazardPointers<T>::HAZARD_PER_THREAD * 2};
-///
-
-
-template <typename T>
-class LockFreeQ
-{
-    private:
-    struct Node
-    {
-        std::atomic<T*> data;
-        std::atomic<Node*> next;
-        
-        Node () : data{NULL}, next{NULL} {}
-        Node (T* pData) : data{pData}, next{NULL} {}
-        Node (T* pData, Node *pNext) : data{pData}, next{pNext} {}
-    };
-
-    std::atomic<Node *> m_head;
-    std::atomic<Node *> m_tail;
-    using HazardPtr = HazardPointers<Node>;
-
-    public:
-
-    LockFreeQ ()
-    {
-        Node* dummy = new Node();
-        m_head.store(dummy);
-        m_tail.store(dummy);
-    }
-    ~LockFreeQ ()
-    {
-        Node *pCrntNode = m_head.load();
-        while (pCrntNode)
-        {
-            Node *pNext = pCrntNode->next.load();
-            T* pData = pCrntNode->data.load();
-            delete pData; pData = NULL;
-            delete pCrntNode;
-            pCrntNode = pNext;
-        }
-    }
-    LockFreeQ (const LockFreeQ&) = delete;
-    LockFreeQ& operator= (const LockFreeQ&) = delete;
-    
-    bool enqueue (T data)
-    {
-        Node *pNode = new Node();
-        T* pData = new T(std::move(data));
-        pNode->data.store(pData);
-        while (true)
-        {
-            Node *pLast = m_tail.load();
-            HazardPtr::protect(0, pLast);
-            if (m_tail.load() != pLast)
-            {
-                HazardPtr::unprotect(0);
-                continue;
-            }
-            Node *pNext = pLast->next.load();
-            if (m_tail.load() == pLast)
-            {
-                if (NULL == pNext)
-                {
-                    if (pLast->next.compare_exchange_weak(pNext, pNode))
-                    {
-                        m_tail.compare_exchange_weak(pLast, pNode);
-                        HazardPtr::unprotect(0);
-                        return true;
-                    }
-                }
-                else {
-                    m_tail.compare_exchange_weak(pLast, pNext);
-                }
-            }
-            HazardPtr::unprotect(0);
-        } 
-        return false;
-    }
-
-    bool dequeue (T &returnValue)
-    {
-        while (true)
-        {
-            Node *pFirst = m_head.load();
-            HazardPtr::protect(0, pFirst);
-            if (m_head.load() != pFirst)
-            {
-                HazardPtr::unprotect(0);
-                continue;
-            }
-            Node *pLast = m_tail.load();
-            Node *pNext = pFirst->next.load();
-            HazardPtr::protect(1, pNext);
-            if (m_head.load() != pFirst)
-            {
-                HazardPtr::unprotect(0);
-                HazardPtr::unprotect(1);
-                continue;
-            }
-            if (pFirst == pLast)
-            {
-                if (NULL == pNext)
-                {
-                    HazardPtr::unprotect(0);
-                    HazardPtr::unprotect(1);
-                    return false;
-                }
-                m_tail.compare_exchange_weak(pLast, pNext);
-            }
-            else
-            {
-                if (NULL == pNext)
-                {
-                    HazardPtr::unprotect(0);
-                    HazardPtr::unprotect(1);
-                    continue;
-                }
-                T* data = pNext->data.load();
-                if (NULL == data)
-                {
-                    HazardPtr::unprotect(0);
-                    HazardPtr::unprotect(1);
-                    continue;    
-                }
-                if (m_head.compare_exchange_weak(pFirst, pNext))
-                {
-                    returnValue = *data;
-                    delete data;
-                    pNext->data.store(NULL);
-                    HazardPtr::unprotect(0);
-                    HazardPtr::unprotect(1);
-                    HazardPtr::retire_Node(pFirst);
-                    return true;
-                }                                
-            }
-            HazardPtr::unprotect(0);
-            HazardPtr::unprotect(1);
-        }
-    }
-
-};
 
 LockFreeQ<lli> q;
 
@@ -270,53 +22,73 @@ void insertQ(lli st, lli end)
 
 FILE *pFile = fopen("Out.txt", "w");
 
-std::mutex m1;
-void removeQ()
+//Consumers count in their own slot, the done flag is only read when the Q looked empty.
+BatchCounter g_dequeued(MAX_T_CNT);
+FinishFlag g_producersDone;
+std::atomic<lli> g_iSum{0};
+void removeQ(size_t iSlot)
 {
-    static lli iCnt = 0;
+    BatchCounter::Local cnt(g_dequeued, iSlot);
+    lli iSum = 0;
     while (1)
     {
         lli iVal;
         if (q.dequeue(iVal)) {
-            std::unique_lock<std::mutex> ul(m1);
-            ++iCnt;
-            if (iCnt == MAX_TESTS*MAX_T_CNT) break;
+            iSum += iVal;
+            cnt.add();
         }
-        else if (iCnt == MAX_TESTS*MAX_T_CNT)
+        else if (g_producersDone.isRaised())
         {
-            return;
+            while (q.dequeue(iVal)) { iSum += iVal; cnt.add(); }
+            break;
         }
     }
+    g_iSum.fetch_add(iSum);
 }
     
 int main()
 {    
-    cout << "Start" << endl;
+    cout << "Start, memory order : " << MO_NAME << endl;
+    PerfCounters counters;      //Before the threads so they inherit the counters.
+    PerfSample sample;
+    counters.start();
     auto startTime = std::chrono::high_resolution_clock::now();
     std::thread t1(insertQ, 1, MAX_TESTS);
     std::thread t2(insertQ, 1, MAX_TESTS);
     std::thread t3(insertQ, 1, MAX_TESTS);
     std::thread t4(insertQ, 1, MAX_TESTS);
     
-    std::thread t5(removeQ);
-    std::thread t6(removeQ);
-    std::thread t7(removeQ);
-    std::thread t8(removeQ);
+    std::thread t5(removeQ, 0);
+    std::thread t6(removeQ, 1);
+    std::thread t7(removeQ, 2);
+    std::thread t8(removeQ, 3);
 
 
     t1.join();
     t2.join();
     t3.join();
     t4.join();
+    g_producersDone.raise();
     t5.join();
     t6.join();
     t7.join();
     t8.join();
     auto endTime = std::chrono::high_resolution_clock::now();
+    counters.stop(sample);
     auto duration = duration_cast<microseconds>(endTime - startTime);
     cout<<"Sec : "<<duration.count()/(1e6)<<endl;
+    lli iExpSum = (lli)MAX_T_CNT * ((lli)MAX_TESTS * (MAX_TESTS + 1) / 2);
+    lli iLeft;
+    bool bOk = (g_iSum.load() == iExpSum) && (g_dequeued.total() == (lli)MAX_TESTS*MAX_T_CNT) && !q.dequeue(iLeft);
+    cout << "Check : sum " << g_iSum.load() << " / " << iExpSum << ", dequeued " << g_dequeued.total()
+         << " -> " << (bOk ? "OK" : "FAILED") << endl;
+    if (!counters.status().empty()) cout << "Note: " << counters.status() << endl;
+    PerfSample::printHeader(cout);
+    cout << "   (per item)" << endl;
+    sample.print(cout, (double)MAX_TESTS*MAX_T_CNT);
+    cout << endl;
     cout << "Exit" << endl;
-    return 0;
+    return bOk ? 0 : 1;
 }
 
 
@@ -329,7 +101,7 @@ int main()
 /*
 1> Cannot traverse this Q
 2> IsEmpty is not safe completely.
-3> Also beyond 16 threads limit it will not work.
+3> At most MAX_THREADS (32) threads may use the Q at the same time, one more aborts (slots are reused after a thread exits).
 4> Some sample examples consider below list and enqueue & dequeue takes place at same time.
 (Dummy)->(1)->(Null)
 */
\ No newline at end of file
@@ -0,0 +1,221 @@
+#ifndef QUEUE_PRIORITY_QUEUE_H
+#define QUEUE_PRIORITY_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+/*
+Concurrent priority queues for "urgent items first" scheduling.
+Both use the same interface as the FIFO queues of Play.cpp plus a priority, smaller = more urgent.
+    bool enqueue(const T& value, uint64_t iPriority)
+    bool dequeue(T& result)                 false when the queue looked empty
+
+LevelPriorityQueue<T, LEVELS, Lane>
+    Small fixed number of levels (<= 64). Every level is its own lock-free FIFO lane (any
+    class with enqueue(const T&) / dequeue(T&), e.g. LockFreeQueue) and one bitmap word has
+    bit p set while level p may hold items. dequeue takes the lowest set bit (one ctz) and
+    pops that lane, so an urgent item overtakes everything queued at lower levels.
+    Items of the same level stay FIFO, exact priority order across levels is guaranteed only
+    against items that were enqueued before the dequeue started (as with any concurrent PQ).
+    The lane has to free its nodes as it goes (LockFreeQueue does, per lane epochs), else
+    every level keeps all nodes it ever held and memory grows with the items pushed so far.
+
+MultiQueue<T>
+    Relaxed queue for unbounded priorities (Rihani, Sanders, Dementiev). C x threads
+    sequential heaps, each behind its own try-lock. enqueue pushes into a random free heap,
+    dequeue looks at the tops of two random heaps and pops the better one. No global
+    hot spot, the returned item is not always the global minimum but close to it (rank
+    error O(threads) on average). Not lock-free in the strict sense, nobody ever waits on a
+    lock, a busy heap is skipped for another random one. Any uint64_t is a valid priority.
+*/
+
+namespace PriorityQ
+{
+    //Per thread xorshift, good enough to spread threads over heaps.
+    inline uint64_t nextRandom()
+    {
+        static thread_local uint64_t iState = 0x9E3779B97F4A7C15ULL ^
+                                              (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+        iState ^= iState << 13;
+        iState ^= iState >> 7;
+        iState ^= iState << 17;
+        return iState;
+    }
+}
+
+
+template<typename T, size_t LEVELS, template<typename> class Lane>
+class LevelPriorityQueue
+{
+    static_assert(LEVELS >= 1 && LEVELS <= 64, "One bitmap word, at most 64 levels");
+
+    private:
+        alignas(64) std::atomic<uint64_t> m_iNonEmpty;
+        std::unique_ptr<Lane<T>> m_lanes[LEVELS];   //Lanes are not movable, each owns its cache lines.
+
+    public:
+    LevelPriorityQueue() : m_iNonEmpty{0}
+    {
+        for (size_t i=0; i<LEVELS; ++i) m_lanes[i].reset(new Lane<T>());
+    }
+    LevelPriorityQueue(const LevelPriorityQueue&) = delete;
+    LevelPriorityQueue& operator=(const LevelPriorityQueue&) = delete;
+
+    static constexpr size_t getLevels() { return LEVELS; }
+
+    //Priorities past the last level are clamped to it.
+    bool enqueue(const T& value, uint64_t iPriority)
+    {
+        size_t iLevel = (iPriority < LEVELS) ? (size_t)iPriority : LEVELS - 1;
+        if (!m_lanes[iLevel]->enqueue(value)) return false;
+        uint64_t iBit = 1ULL << iLevel;
+        //Fence pairs with the one in dequeue. Plain load before the RMW, under load the bit is
+        //almost always set already and the bitmap line then stays shared instead of bouncing.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!(m_iNonEmpty.load(std::memory_order_relaxed) & iBit))
+            m_iNonEmpty.fetch_or(iBit, std::memory_order_acq_rel);
+        return true;
+    }
+
+    bool dequeue(T& result)
+    {
+        uint64_t iMask = m_iNonEmpty.load(std::memory_order_acquire);
+        while (iMask)
+        {
+            size_t iLevel = (size_t)__builtin_ctzll(iMask);
+            uint64_t iBit = 1ULL << iLevel;
+            if (m_lanes[iLevel]->dequeue(result)) return true;
+
+            /*
+            Lane looked empty, clear its bit then look once more. With a seq_cst fence on both
+            sides either the enqueuer's bitmap load sees the clear (and sets the bit again) or
+            the second dequeue sees the item, so a bit is never lost while its lane has items.
+            */
+            m_iNonEmpty.fetch_and(~iBit, std::memory_order_acq_rel);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_lanes[iLevel]->dequeue(result))
+            {
+                m_iNonEmpty.fetch_or(iBit, std::memory_order_acq_rel);   //May hold more, keep it visible.
+                return true;
+            }
+            iMask = m_iNonEmpty.load(std::memory_order_acquire);
+        }
+        return false;
+    }
+
+    inline bool isEmpty() const { return 0 == m_iNonEmpty.load(std::memory_order_acquire); }
+};
+
+
+template<typename T>
+class MultiQueue
+{
+    private:
+        static constexpr int DEQUEUE_TRIES = 8;  //Random picks before a full scan for emptiness.
+
+        struct Entry
+        {
+            uint64_t m_iPriority;
+            T m_value;
+            bool operator<(const Entry& other) const { return m_iPriority > other.m_iPriority; }   //Min heap.
+        };
+
+        struct alignas(64) Heap
+        {
+            std::mutex m_mutex;
+            //Read without the lock. Emptiness has its own flag, every priority value is a valid
+            //top (a UINT64_MAX "empty" marker would hide items of priority UINT64_MAX).
+            std::atomic<bool> m_bHasItems{false};
+            std::atomic<uint64_t> m_iTop{0};        //Priority of the top, only meaningful with m_bHasItems.
+            std::priority_queue<Entry> m_heap;
+
+            inline void updateTop()
+            {
+                if (!m_heap.empty()) m_iTop.store(m_heap.top().m_iPriority, std::memory_order_relaxed);
+                m_bHasItems.store(!m_heap.empty(), std::memory_order_release);
+            }
+        };
+
+        std::unique_ptr<Heap[]> m_pHeaps;
+        size_t m_iHeapCnt;
+
+        inline size_t randomHeap() const { return (size_t)(PriorityQ::nextRandom() % m_iHeapCnt); }
+
+        //Caller has seen items in heap, false if it is busy or was emptied meanwhile (bBusy tells which).
+        bool popFrom(Heap& heap, T& result, bool& bBusy)
+        {
+            std::unique_lock<std::mutex> lock(heap.m_mutex, std::try_to_lock);
+            bBusy = !lock.owns_lock();
+            if (bBusy || heap.m_heap.empty()) return false;
+            result = heap.m_heap.top().m_value;
+            heap.m_heap.pop();
+            heap.updateTop();
+            return true;
+        }
+
+    public:
+    //iHeapsPerThread = C, 2 .. 4 keeps contention low while the rank error stays small.
+    explicit MultiQueue(size_t iThreads = std::thread::hardware_concurrency(), size_t iHeapsPerThread = 2)
+        : m_pHeaps{}, m_iHeapCnt{std::max<size_t>(2, std::max<size_t>(1, iThreads) * iHeapsPerThread)}
+    {
+        m_pHeaps.reset(new Heap[m_iHeapCnt]);
+    }
+    MultiQueue(const MultiQueue&) = delete;
+    MultiQueue& operator=(const MultiQueue&) = delete;
+
+    bool enqueue(const T& value, uint64_t iPriority)
+    {
+        while (true)
+        {
+            Heap& heap = m_pHeaps[randomHeap()];
+            std::unique_lock<std::mutex> lock(heap.m_mutex, std::try_to_lock);
+            if (!lock.owns_lock()) continue;
+            bool bWasEmpty = heap.m_heap.empty();
+            heap.m_heap.push(Entry{iPriority, value});
+            if (bWasEmpty || iPriority < heap.m_iTop.load(std::memory_order_relaxed)) heap.updateTop();
+            return true;
+        }
+    }
+
+    bool dequeue(T& result)
+    {
+        bool bBusy;
+        for (int iTry=0; iTry<DEQUEUE_TRIES; ++iTry)
+        {
+            size_t a = randomHeap(), b = randomHeap();
+            bool bHasA = m_pHeaps[a].m_bHasItems.load(std::memory_order_acquire);
+            bool bHasB = m_pHeaps[b].m_bHasItems.load(std::memory_order_acquire);
+            if (!bHasA && !bHasB) continue;
+            size_t iPick = !bHasB ? a : !bHasA ? b :
+                           (m_pHeaps[a].m_iTop.load(std::memory_order_relaxed) <=
+                            m_pHeaps[b].m_iTop.load(std::memory_order_relaxed)) ? a : b;
+            if (popFrom(m_pHeaps[iPick], result, bBusy)) return true;
+        }
+        //Few heaps hold items, find them instead of guessing. Same two choice idea is lost
+        //here but this only happens when the queue is nearly empty. Busy heaps are skipped
+        //too, the scan is repeated while one was busy so false still means "looked empty".
+        do
+        {
+            bool bSkipped = false;
+            for (size_t i=0; i<m_iHeapCnt; ++i)
+            {
+                Heap& heap = m_pHeaps[i];
+                if (!heap.m_bHasItems.load(std::memory_order_acquire)) continue;
+                if (popFrom(heap, result, bBusy)) return true;
+                bSkipped |= bBusy;
+            }
+            bBusy = bSkipped;
+        } while (bBusy);
+        return false;
+    }
+};
+
+#endif
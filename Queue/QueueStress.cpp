@@ -0,0 +1,316 @@
+#include <bits/stdc++.h>
+#include "LockFreeQ.h"
+#include "LockFreeQueue.h"
+#include "PriorityQueue.h"
+#include "AsyncQueue.h"
+#include "SpillQueue.h"
+#include "ShmRingQ.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+Linearizability stress test for every queue engine of this directory.
+Each round picks random producer & consumer counts, item counts and schedule noise (yields,
+spins, bursts per thread), producers push (producer << 40 | sequence) items, consumers keep
+everything they received. After the round...
+    exactly once   every (producer, sequence) was received once, nothing lost or duplicated,
+                   the queue is empty.
+    FIFO           per consumer, the sequences of every producer are increasing (any
+                   linearizable FIFO must give that), skipped for MultiQueue (relaxed order).
+A round that makes no progress for 5 s is reported as lost items instead of hanging.
+
+Compile: g++ -O2 -std=c++20 -pthread QueueStress.cpp -lrt
+TSan   : sh QueueStressTsan.sh [rounds (default 2)] [seed (default 777)] [engine name filter]
+         runs the default ordering plain, then under TSan with -DLFQ_SEQ_CST and with the
+         default ordering (TSan doesn't model atomic_thread_fence, see the script), fails on
+         the first failed check or reported race.
+Run    : ./a.out [rounds per engine (default 20)] [seed] [engine name filter]
+Exit code is 1 if any engine failed a check.
+*/
+
+const int SEQ_BITS = 40;
+const int MAX_PRODUCERS = 8, MAX_CONSUMERS = 8;
+
+/*
+Engines, push must not fail (retry inside for bounded queues), pop returns false when empty.
+LevelPQ gives every producer its own level, per producer FIFO must then still hold.
+MultiQueue gets every 8th item at priority UINT64_MAX, the largest valid one.
+*/
+struct LockFreeQEngine
+{
+    static constexpr bool FIFO = true;
+    LockFreeQ<lli> q;
+    void push(lli v) { q.enqueue(v); }
+    bool pop(lli& v) { return q.dequeue(v); }
+};
+
+struct LockFreeQueueEngine
+{
+    static constexpr bool FIFO = true;
+    LockFreeQueue<lli> q;
+    void push(lli v) { q.enqueue(v); }
+    bool pop(lli& v) { return q.dequeue(v); }
+};
+
+struct LevelPQEngine
+{
+    static constexpr bool FIFO = true;
+    LevelPriorityQueue<lli, 8, LockFreeQueue> q;
+    void push(lli v) { q.enqueue(v, (uint64_t)(v >> SEQ_BITS) % 8); }
+    bool pop(lli& v) { return q.dequeue(v); }
+};
+
+struct MultiQueueEngine
+{
+    static constexpr bool FIFO = false;
+    MultiQueue<lli> q{MAX_PRODUCERS + MAX_CONSUMERS};
+    void push(lli v)
+    {
+        uint64_t iSeq = (uint64_t)(v & ((1LL << SEQ_BITS) - 1));
+        q.enqueue(v, (7 == (iSeq & 7)) ? UINT64_MAX : iSeq);
+    }
+    bool pop(lli& v) { return q.dequeue(v); }
+};
+
+struct AsyncQueueEngine
+{
+    static constexpr bool FIFO = true;
+    AsyncQueue<lli> q;
+    void push(lli v) { q.push(v); }
+    bool pop(lli& v) { return q.tryPop(v); }
+};
+
+struct SpillQueueEngine
+{
+    static constexpr bool FIFO = true;
+    static SpillQueue<lli>::Config config()
+    {
+        SpillQueue<lli>::Config c;
+        c.m_strDir = "/tmp/queue_stress_spill";
+        c.m_iHighWatermark = 512;               //Tiny, so most rounds spill & refill a lot.
+        c.m_iBatchItems = 128;
+        c.m_iSegmentBytes = 16 << 10;
+        return c;
+    }
+    SpillQueue<lli> q{config()};
+    ~SpillQueueEngine() { rmdir(config().m_strDir.c_str()); }
+    void push(lli v) { q.enqueue(v); }
+    bool pop(lli& v) { return q.dequeue(v); }
+};
+
+struct ShmRingQEngine
+{
+    static constexpr bool FIFO = true;
+    ShmRingQ<lli> q;
+    ShmRingQEngine()
+    {
+        ShmRingQ<lli>::unlink("/queue_stress_shm");
+        if (!q.create("/queue_stress_shm", 256, ShmRingQ<lli>::MPMC)) abort();
+    }
+    ~ShmRingQEngine() { ShmRingQ<lli>::unlink("/queue_stress_shm"); }
+    void push(lli v) { while (!q.tryEnqueue(v)) this_thread::yield(); }
+    bool pop(lli& v) { return q.tryDequeue(v); }
+};
+
+
+//Per thread schedule noise, different every round & thread.
+class Noise
+{
+    private:
+        mt19937_64 m_rng;
+        int m_iYieldPct, m_iSpinPct, m_iBurst, m_iLeft;
+
+    public:
+    explicit Noise(uint64_t iSeed) : m_rng(iSeed)
+    {
+        m_iYieldPct = (int)(m_rng() % 20);
+        m_iSpinPct = (int)(m_rng() % 20);
+        m_iBurst = 1 + (int)(m_rng() % 256);
+        m_iLeft = m_iBurst;
+    }
+
+    inline void step()
+    {
+        if (--m_iLeft > 0) return;
+        m_iLeft = m_iBurst;
+        int iDice = (int)(m_rng() % 100);
+        if (iDice < m_iYieldPct) this_thread::yield();
+        else if (iDice < m_iYieldPct + m_iSpinPct)
+        {
+            for (int i = (int)(m_rng() % 2000); i > 0; --i) atomic_signal_fence(memory_order_seq_cst);
+        }
+    }
+};
+
+struct RoundResult
+{
+    bool m_bOk;
+    string m_strError;
+};
+
+template<typename Engine>
+RoundResult runRound(mt19937_64& rng)
+{
+    int iProducers = 1 + (int)(rng() % MAX_PRODUCERS);
+    int iConsumers = 1 + (int)(rng() % MAX_CONSUMERS);
+    lli iItems = 1 + (lli)(rng() % 50'000);
+    lli iTotal = iItems * iProducers;
+
+    unique_ptr<Engine> pEngine(new Engine());
+    vector<vector<lli>> vecReceived(iConsumers);
+    atomic<lli> iConsumed{0};
+    atomic<int> iProducersLeft{iProducers};
+    atomic<bool> bGiveUp{false};
+    vector<uint64_t> vecSeeds(iProducers + iConsumers);
+    for (auto& s : vecSeeds) s = rng();
+
+    vector<thread> vecThreads;
+    for (int p=0; p<iProducers; ++p)
+    {
+        vecThreads.emplace_back([&, p]()
+        {
+            Noise noise(vecSeeds[p]);
+            for (lli i=0; i<iItems; ++i)
+            {
+                pEngine->push(((lli)p << SEQ_BITS) | i);
+                noise.step();
+            }
+            iProducersLeft.fetch_sub(1, memory_order_release);
+        });
+    }
+    for (int c=0; c<iConsumers; ++c)
+    {
+        vecThreads.emplace_back([&, c]()
+        {
+            Noise noise(vecSeeds[iProducers + c]);
+            vector<lli>& vecMine = vecReceived[c];
+            lli iVal;
+            while (!bGiveUp.load(memory_order_relaxed))
+            {
+                if (pEngine->pop(iVal))
+                {
+                    vecMine.push_back(iVal);
+                    iConsumed.fetch_add(1, memory_order_relaxed);
+                }
+                else if (0 == iProducersLeft.load(memory_order_acquire) &&
+                         iConsumed.load(memory_order_relaxed) >= iTotal)
+                {
+                    return;
+                }
+                noise.step();
+            }
+        });
+    }
+
+    //Watchdog, a lost item would make the consumers wait forever.
+    lli iLastConsumed = -1;
+    auto lastProgress = steady_clock::now();
+    while (iConsumed.load() < iTotal || iProducersLeft.load() > 0)
+    {
+        this_thread::sleep_for(milliseconds(5));
+        lli iNow = iConsumed.load();
+        if (iNow != iLastConsumed) { iLastConsumed = iNow; lastProgress = steady_clock::now(); }
+        else if (steady_clock::now() - lastProgress > seconds(5)) { bGiveUp = true; break; }
+    }
+    for (auto& t : vecThreads) t.join();
+
+    char szRound[96];
+    snprintf(szRound, sizeof(szRound), "%dP/%dC x %lld items : ", iProducers, iConsumers, iItems);
+    vector<vector<unsigned char>> vecSeen(iProducers, vector<unsigned char>(iItems, 0));
+    for (int c=0; c<iConsumers; ++c)
+    {
+        vector<lli> vecLast(iProducers, -1);
+        for (lli iVal : vecReceived[c])
+        {
+            int p = (int)(iVal >> SEQ_BITS);
+            lli iSeq = iVal & ((1LL << SEQ_BITS) - 1);
+            if (p < 0 || p >= iProducers || iSeq >= iItems)
+                return {false, szRound + string("garbage item ") + to_string(iVal)};
+            if (vecSeen[p][iSeq]++)
+                return {false, szRound + string("duplicate P") + to_string(p) + " #" + to_string(iSeq)};
+            if (Engine::FIFO && iSeq <= vecLast[p])
+                return {false, szRound + string("FIFO broken, consumer ") + to_string(c) + " got P" + to_string(p) +
+                               " #" + to_string(iSeq) + " after #" + to_string(vecLast[p])};
+            vecLast[p] = iSeq;
+        }
+    }
+    for (int p=0; p<iProducers; ++p)
+    {
+        for (lli i=0; i<iItems; ++i)
+        {
+            if (!vecSeen[p][i]) return {false, szRound + string("lost P") + to_string(p) + " #" + to_string(i)};
+        }
+    }
+    lli iExtra;
+    if (pEngine->pop(iExtra)) return {false, szRound + string("queue not empty after the round")};
+    return {true, ""};
+}
+
+template<typename Engine>
+bool runEngine(const string& strName, int iRounds, uint64_t iSeed, const string& strFilter)
+{
+    if (!strFilter.empty() && strName.find(strFilter) == string::npos) return true;
+    mt19937_64 rng(iSeed ^ hash<string>()(strName));
+    auto startTime = steady_clock::now();
+    for (int r=0; r<iRounds; ++r)
+    {
+        RoundResult result = runRound<Engine>(rng);
+        if (!result.m_bOk)
+        {
+            cout << setw(16) << strName << " : FAILED in round " << r << ", " << result.m_strError << endl;
+            return false;
+        }
+    }
+    double dSec = duration_cast<milliseconds>(steady_clock::now() - startTime).count() / 1e3;
+    cout << setw(16) << strName << " : " << iRounds << " rounds OK (" << dSec << " s)"
+         << (Engine::FIFO ? "" : ", exactly once only") << endl;
+    return true;
+}
+
+/*
+Single threaded edge cases of MultiQueue's priorities: an item of priority UINT64_MAX in an
+otherwise empty queue must come out, and with a few heaps drained the order is min first.
+*/
+bool runMultiQueueEdges(const string& strFilter)
+{
+    if (!strFilter.empty() && string("MultiQueue").find(strFilter) == string::npos) return true;
+    bool bOk = true;
+    lli iVal = 0;
+    {
+        MultiQueue<lli> q(1, 2);
+        bOk &= q.enqueue(42, UINT64_MAX);
+        bOk &= q.dequeue(iVal) && (42 == iVal) && !q.dequeue(iVal);
+    }
+    {
+        MultiQueue<lli> q(1, 2);
+        const uint64_t PRIORITIES[] = {UINT64_MAX, 0, UINT64_MAX - 1, 5, UINT64_MAX};
+        for (uint64_t iPriority : PRIORITIES) q.enqueue((lli)(iPriority >> 1), iPriority);
+        int iCount = 0;
+        while (q.dequeue(iVal)) ++iCount;
+        bOk &= (5 == iCount);
+    }
+    cout << setw(16) << "MultiQueue" << " : priority UINT64_MAX " << (bOk ? "OK" : "FAILED, items lost") << endl;
+    return bOk;
+}
+
+int main(int argc, char** argv)
+{
+    int iRounds = (argc > 1) ? atoi(argv[1]) : 20;
+    uint64_t iSeed = (argc > 2) ? strtoull(argv[2], NULL, 10) : (uint64_t)time(NULL);
+    string strFilter = (argc > 3) ? argv[3] : "";
+    cout << "Queue stress, " << iRounds << " rounds per engine, seed " << iSeed
+         << ", memory order " << MO_NAME << endl;
+
+    bool bOk = true;
+    bOk &= runEngine<LockFreeQEngine>("LockFreeQ", iRounds, iSeed, strFilter);
+    bOk &= runEngine<LockFreeQueueEngine>("LockFreeQueue", iRounds, iSeed, strFilter);
+    bOk &= runEngine<LevelPQEngine>("LevelPQ", iRounds, iSeed, strFilter);
+    bOk &= runEngine<MultiQueueEngine>("MultiQueue", iRounds, iSeed, strFilter);
+    bOk &= runMultiQueueEdges(strFilter);
+    bOk &= runEngine<AsyncQueueEngine>("AsyncQueue", iRounds, iSeed, strFilter);
+    bOk &= runEngine<SpillQueueEngine>("SpillQueue", iRounds, iSeed, strFilter);
+    bOk &= runEngine<ShmRingQEngine>("ShmRingQ", iRounds, iSeed, strFilter);
+    cout << (bOk ? "All engines passed." : "FAILED, rerun with the same seed to reproduce.") << endl;
+    return bOk ? 0 : 1;
+}
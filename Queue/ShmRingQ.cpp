@@ -0,0 +1,210 @@
+#include <bits/stdc++.h>
+#include <sys/wait.h>
+#include "ShmRingQ.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+Two (or more) process test of ShmRingQ.
+Parent creates the region, forks producer & consumer processes which attach to it by name.
+Producers push 0..N-1, consumers stop on a -1 pill (one per consumer, sent by the parent once
+all producers exited). Every consumer reports count & sum through a pipe, the parent checks
+nothing was lost or duplicated. In SPSC mode the consumer also checks FIFO order.
+bytes mode runs ShmByteRingQ with one producer & one consumer, records of 16 B .. 4 KB carry
+their sequence number and a byte pattern derived from it, the consumer verifies both.
+Every run first checks that attach gives up on a region whose creator died before it was ready.
+
+Compile: g++ -O3 -std=c++17 ShmRingQ.cpp -lrt
+Run    : ./a.out [spsc|mpmc] [items per producer] [producers] [consumers]
+         ./a.out bytes [records]
+*/
+
+const char* SHM_NAME = "/shm_ring_q_test";
+
+void producer(lli iItems)
+{
+    ShmRingQ<lli> q;
+    if (!q.attach(SHM_NAME)) _exit(1);
+    for (lli i=0; i<iItems; ++i) q.enqueue(i);
+    _exit(0);
+}
+
+void consumer(int fdOut, bool bCheckOrder)
+{
+    ShmRingQ<lli> q;
+    if (!q.attach(SHM_NAME)) _exit(1);
+    lli iResult[2] = {0, 0};                    //Count, sum.
+    lli iExpected = 0;
+    while (true)
+    {
+        lli iVal;
+        q.dequeue(iVal);
+        if (-1 == iVal) break;
+        if (bCheckOrder && iVal != iExpected++)
+        {
+            fprintf(stderr, "Out of order : got %lld\n", iVal);
+            _exit(2);
+        }
+        ++iResult[0];
+        iResult[1] += iVal;
+    }
+    if (write(fdOut, iResult, sizeof(iResult)) != sizeof(iResult)) _exit(3);
+    _exit(0);
+}
+
+//Record i : sequence number then (i + k) & 0xFF filler, length 16 .. 4096 picked from i.
+inline size_t recordLen(lli i) { return 16 + (size_t)((i * 2654435761LL) & 0xFFF) % 4081; }
+
+void byteProducer(lli iRecords)
+{
+    ShmByteRingQ q;
+    if (!q.attach(SHM_NAME)) _exit(1);
+    for (lli i=0; i<iRecords; ++i)
+    {
+        size_t iLen = recordLen(i);
+        char* p = q.reserveBlocking(iLen);
+        memcpy(p, &i, sizeof(i));
+        for (size_t k=sizeof(i); k<iLen; ++k) p[k] = (char)((i + k) & 0xFF);
+        q.commit(iLen);
+    }
+    _exit(0);
+}
+
+void byteConsumer(int fdOut, lli iRecords)
+{
+    ShmByteRingQ q;
+    if (!q.attach(SHM_NAME)) _exit(1);
+    lli iResult[2] = {0, 0};                    //Records, bytes.
+    for (lli i=0; i<iRecords; ++i)
+    {
+        size_t iLen;
+        const char* p = q.peekBlocking(iLen);
+        lli iSeq;
+        memcpy(&iSeq, p, sizeof(iSeq));
+        bool bOk = (iSeq == i) && (iLen == recordLen(i));
+        for (size_t k=sizeof(iSeq); bOk && k<iLen; ++k) bOk = (p[k] == (char)((i + k) & 0xFF));
+        if (!bOk)
+        {
+            fprintf(stderr, "Bad record %lld : seq %lld, len %zu\n", i, iSeq, iLen);
+            _exit(2);
+        }
+        q.release();
+        ++iResult[0];
+        iResult[1] += iLen;
+    }
+    if (write(fdOut, iResult, sizeof(iResult)) != sizeof(iResult)) _exit(3);
+    _exit(0);
+}
+
+int runBytes(lli iRecords)
+{
+    ShmByteRingQ::unlink(SHM_NAME);
+    ShmByteRingQ q;
+    if (!q.create(SHM_NAME, 1 << 20)) return 1;
+
+    int fdPipe[2];
+    if (pipe(fdPipe) != 0) { perror("pipe"); return 1; }
+
+    cout << "BYTES : 1 producer & 1 consumer process, " << iRecords << " records of 16 .. 4096 bytes" << endl;
+    auto startTime = high_resolution_clock::now();
+    if (0 == fork()) byteConsumer(fdPipe[1], iRecords);
+    if (0 == fork()) byteProducer(iRecords);
+
+    lli iResult[2] = {0, 0};
+    bool bOk = read(fdPipe[0], iResult, sizeof(iResult)) == sizeof(iResult);
+    int iStatus;
+    while (wait(&iStatus) > 0) bOk &= WIFEXITED(iStatus) && 0 == WEXITSTATUS(iStatus);
+    auto endTime = high_resolution_clock::now();
+    double dSec = duration_cast<microseconds>(endTime - startTime).count() / 1e6;
+
+    bOk &= (iResult[0] == iRecords);
+    cout << "Received " << iResult[0] << " / " << iRecords << " records in " << dSec << " s, "
+         << iResult[0] / dSec / 1e6 << " Mrec/s, " << iResult[1] / dSec / (1 << 20) << " MB/s -> "
+         << (bOk ? "OK" : "FAILED") << endl;
+
+    ShmByteRingQ::unlink(SHM_NAME);
+    return bOk ? 0 : 1;
+}
+
+//Child creates the region and exits before publishing ready, attach must fail instead of hanging.
+bool runDeadCreator()
+{
+    ShmRingQ<lli>::unlink(SHM_NAME);
+    if (0 == fork())
+    {
+        _exit(ShmRing::createRegion(SHM_NAME, 4096, ShmRing::MPMC, 64, sizeof(lli)) ? 0 : 1);
+    }
+    int iStatus;
+    bool bOk = (wait(&iStatus) > 0) && WIFEXITED(iStatus) && 0 == WEXITSTATUS(iStatus);
+    ShmRingQ<lli> q;
+    auto startTime = steady_clock::now();
+    bOk &= !q.attach(SHM_NAME, 200);
+    lli iMs = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+    ShmRingQ<lli>::unlink(SHM_NAME);
+    cout << "dead creator : attach gave up after " << iMs << " ms -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+int main(int argc, char** argv)
+{
+    if (!runDeadCreator()) return 1;
+    if (argc > 1 && string("bytes") == argv[1]) return runBytes((argc > 2) ? atoll(argv[2]) : 2'000'000);
+
+    bool bMpmc = (argc > 1) && (string("mpmc") == argv[1]);
+    lli iItems = (argc > 2) ? atoll(argv[2]) : 10'000'000;
+    int iProducers = bMpmc ? ((argc > 3) ? atoi(argv[3]) : 2) : 1;
+    int iConsumers = bMpmc ? ((argc > 4) ? atoi(argv[4]) : 2) : 1;
+
+    ShmRingQ<lli>::unlink(SHM_NAME);            //Leftover of a crashed run.
+    ShmRingQ<lli> q;
+    if (!q.create(SHM_NAME, 4096, bMpmc ? ShmRingQ<lli>::MPMC : ShmRingQ<lli>::SPSC)) return 1;
+
+    int fdPipe[2];
+    if (pipe(fdPipe) != 0) { perror("pipe"); return 1; }
+
+    cout << (bMpmc ? "MPMC" : "SPSC") << " : " << iProducers << " producer & " << iConsumers
+         << " consumer processes, " << iItems << " items each producer" << endl;
+    auto startTime = high_resolution_clock::now();
+
+    vector<pid_t> vecProducers;
+    for (int i=0; i<iConsumers; ++i)
+    {
+        if (0 == fork()) consumer(fdPipe[1], !bMpmc);
+    }
+    for (int i=0; i<iProducers; ++i)
+    {
+        pid_t pid = fork();
+        if (0 == pid) producer(iItems);
+        vecProducers.push_back(pid);
+    }
+
+    bool bOk = true;
+    for (pid_t pid : vecProducers)
+    {
+        int iStatus;
+        waitpid(pid, &iStatus, 0);
+        bOk &= WIFEXITED(iStatus) && 0 == WEXITSTATUS(iStatus);
+    }
+    for (int i=0; i<iConsumers; ++i) q.enqueue(-1);
+
+    lli iCount = 0, iSum = 0;
+    for (int i=0; i<iConsumers; ++i)
+    {
+        lli iResult[2];
+        if (read(fdPipe[0], iResult, sizeof(iResult)) != sizeof(iResult)) { bOk = false; break; }
+        iCount += iResult[0];
+        iSum += iResult[1];
+    }
+    while (wait(NULL) > 0);
+    auto endTime = high_resolution_clock::now();
+    double dSec = duration_cast<microseconds>(endTime - startTime).count() / 1e6;
+
+    lli iExpCount = iItems * iProducers, iExpSum = iProducers * (iItems * (iItems - 1) / 2);
+    bOk &= (iCount == iExpCount) && (iSum == iExpSum);
+    cout << "Received " << iCount << " / " << iExpCount << " items in " << dSec << " s, "
+         << iCount / dSec / 1e6 << " Mops/s -> " << (bOk ? "OK" : "FAILED") << endl;
+
+    ShmRingQ<lli>::unlink(SHM_NAME);
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,570 @@
+#ifndef QUEUE_SHM_RING_Q_H
+#define QUEUE_SHM_RING_Q_H
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+
+/*
+Inter process ring buffers, same ring as CircularQ (fixed capacity, index wraps with getNext)
+but storage and indices live in a POSIX shared memory object so processes on one host can
+exchange messages without sockets or copies through the kernel.
+    ShmRingQ<T>    fixed size items, SPSC or MPMC.
+    ShmByteRingQ   variable length records, SPSC, zero copy reserve/commit & peek/release.
+
+Shared region layout (fixed, checked on attach)...
+    line 0    magic, version, mode, capacity, item size, ready flag
+    line 1    tail (producers)                      own cache line each, a producer moving
+    line 2    head (consumers)                      tail never invalidates the consumer's head
+    line 3    not-empty futex word + waiting consumers
+    line 4    not-full  futex word + waiting producers
+    line 5..  ring storage
+
+Blocking calls spin shortly, then sleep on a futex word in the region. The futex is not
+FUTEX_PRIVATE so a producer in one process wakes a consumer in another.
+Capacity is rounded up to a power of 2 so getNext is a mask instead of %.
+*/
+
+namespace ShmRing
+{
+    static constexpr uint64_t MAGIC = 0x51474e4952485348ULL;   //"HSHRINGQ" (little endian bytes)
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int SPIN_BEFORE_SLEEP = 256;
+    static constexpr int ATTACH_TIMEOUT_MS = 5000;              //Creator died before publishing ready.
+
+    enum Mode : uint32_t { SPSC = 1, MPMC = 2, BYTES = 3 };
+
+    struct alignas(64) Header
+    {
+        uint64_t m_iMagic;
+        uint32_t m_iVersion;
+        uint32_t m_eMode;
+        uint64_t m_iCapacity;                   //Slots, or bytes for BYTES mode.
+        uint64_t m_iItemSize;                   //sizeof(T), 0 for BYTES mode.
+        std::atomic<uint32_t> m_iReady;
+
+        alignas(64) std::atomic<uint64_t> m_iTail;
+        alignas(64) std::atomic<uint64_t> m_iHead;
+        alignas(64) std::atomic<uint32_t> m_iNotEmpty;
+        std::atomic<uint32_t> m_iWaitingConsumers;
+        alignas(64) std::atomic<uint32_t> m_iNotFull;
+        std::atomic<uint32_t> m_iWaitingProducers;
+    };
+
+    inline void futexWait(std::atomic<uint32_t>* pWord, uint32_t iExpected)
+    {
+        syscall(SYS_futex, (uint32_t*)pWord, FUTEX_WAIT, iExpected, NULL, NULL, 0);
+    }
+    inline void futexWake(std::atomic<uint32_t>* pWord, int iCount)
+    {
+        syscall(SYS_futex, (uint32_t*)pWord, FUTEX_WAKE, iCount, NULL, NULL, 0);
+    }
+
+    //Wakes a sleeper of the other side, if there is one, after this side made progress.
+    inline void signal(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);   //Pairs with the fence in waitFor.
+        if (waiting.load(std::memory_order_relaxed) > 0)
+        {
+            word.fetch_add(1, std::memory_order_release);
+            futexWake(&word, 1);
+        }
+    }
+
+    /*
+    Registers as waiter, re-checks, then sleeps until word moves. A signal between the check
+    and the sleep changes word so FUTEX_WAIT returns at once, no lost wakeup.
+    */
+    template <typename TryFn>
+    void waitFor(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting, TryFn tryOp)
+    {
+        for (int i=0; i<SPIN_BEFORE_SLEEP; ++i)
+        {
+            if (tryOp()) return;
+        }
+        while (true)
+        {
+            uint32_t iSeen = word.load(std::memory_order_acquire);
+            waiting.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (tryOp())
+            {
+                waiting.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            futexWait(&word, iSeen);
+            waiting.fetch_sub(1, std::memory_order_relaxed);
+            if (tryOp()) return;
+        }
+    }
+
+    inline uint64_t roundUpPow2(uint64_t iSize)
+    {
+        uint64_t iCapacity = 1;
+        while (iCapacity < iSize) iCapacity <<= 1;
+        return iCapacity;
+    }
+
+    /*
+    Creates the named object (fails if it exists) and maps iBytes of it. Header fields are
+    filled but m_iReady is left 0, the caller publishes it once the storage is initialized.
+    */
+    inline Header* createRegion(const std::string& strName, size_t iBytes, Mode eMode, uint64_t iCapacity, uint64_t iItemSize)
+    {
+        int fd = shm_open(strName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) { perror(("shm_open " + strName).c_str()); return NULL; }
+        void* pAddr = MAP_FAILED;
+        if (0 == ftruncate(fd, iBytes)) pAddr = mmap(NULL, iBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (MAP_FAILED == pAddr)
+        {
+            perror("ftruncate / mmap");
+            shm_unlink(strName.c_str());
+            return NULL;
+        }
+
+        Header* pHdr = (Header*)pAddr;
+        pHdr->m_iMagic = MAGIC;
+        pHdr->m_iVersion = VERSION;
+        pHdr->m_eMode = eMode;
+        pHdr->m_iCapacity = iCapacity;
+        pHdr->m_iItemSize = iItemSize;
+        pHdr->m_iTail.store(0, std::memory_order_relaxed);
+        pHdr->m_iHead.store(0, std::memory_order_relaxed);
+        pHdr->m_iNotEmpty.store(0, std::memory_order_relaxed);
+        pHdr->m_iWaitingConsumers.store(0, std::memory_order_relaxed);
+        pHdr->m_iNotFull.store(0, std::memory_order_relaxed);
+        pHdr->m_iWaitingProducers.store(0, std::memory_order_relaxed);
+        return pHdr;
+    }
+
+    /*
+    Maps an existing object, waits until it is ready & checks magic / version / item size.
+    A region that is not ready after iTimeoutMs (its creator died half way) fails the attach,
+    the name is then stale and has to be unlinked before it can be created again.
+    */
+    inline Header* attachRegion(const std::string& strName, uint64_t iItemSize, size_t& iBytes, int iTimeoutMs)
+    {
+        int fd = shm_open(strName.c_str(), O_RDWR, 0600);
+        if (fd < 0) { perror(("shm_open " + strName).c_str()); return NULL; }
+        struct stat st;
+        void* pAddr = MAP_FAILED;
+        if (0 == fstat(fd, &st) && (size_t)st.st_size >= sizeof(Header))
+        {
+            iBytes = st.st_size;
+            pAddr = mmap(NULL, iBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (MAP_FAILED == pAddr) { perror("mmap"); return NULL; }
+
+        Header* pHdr = (Header*)pAddr;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iTimeoutMs);
+        while (0 == pHdr->m_iReady.load(std::memory_order_acquire))
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                fprintf(stderr, "ShmRing %s : not ready after %d ms, creator gone?\n", strName.c_str(), iTimeoutMs);
+                munmap(pAddr, iBytes);
+                return NULL;
+            }
+            sched_yield();
+        }
+        if (MAGIC != pHdr->m_iMagic || VERSION != pHdr->m_iVersion || iItemSize != pHdr->m_iItemSize)
+        {
+            fprintf(stderr, "ShmRing %s : header mismatch (item size %zu expected)\n", strName.c_str(), (size_t)iItemSize);
+            munmap(pAddr, iBytes);
+            return NULL;
+        }
+        return pHdr;
+    }
+}
+
+
+/*
+Fixed size items.
+    SPSC  one producer & one consumer process, plain load/store on head & tail, the sequence
+          field is unused. Each side caches the other's index to touch the shared line rarely.
+    MPMC  any number of both, Vyukov's bounded queue, each slot's sequence number tells
+          whether it is free for lap n or holds data of lap n, one CAS per operation.
+*/
+template <typename T = long long>
+class ShmRingQ
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ShmRingQ stores raw bytes, T must be trivially copyable");
+
+    public:
+    typedef ShmRing::Mode Mode;
+    static constexpr Mode SPSC = ShmRing::SPSC;
+    static constexpr Mode MPMC = ShmRing::MPMC;
+
+    private:
+    typedef ShmRing::Header Header;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> m_iSeq;
+        T m_value;
+    };
+
+    Header *m_pHdr;
+    Slot *m_pSlots;
+    size_t m_iMapBytes;
+    uint64_t m_iMask;
+    uint64_t m_iCachedHead, m_iCachedTail;      //SPSC only, this process' view of the other side.
+
+    static size_t regionBytes(uint64_t iCapacity) { return sizeof(Header) + iCapacity * sizeof(Slot); }
+
+    public:
+    ShmRingQ() : m_pHdr{NULL}, m_pSlots{NULL}, m_iMapBytes{0}, m_iMask{0}, m_iCachedHead{0}, m_iCachedTail{0} {}
+    ShmRingQ(const ShmRingQ&) = delete;
+    ShmRingQ& operator=(const ShmRingQ&) = delete;
+    ~ShmRingQ() { detach(); }
+
+    /*
+    Creates & initializes the shared object, fails if it already exists.
+    m_iReady is published last, attach() waits for it (up to its timeout) so it never sees a half built region.
+    */
+    bool create(const std::string& strName, size_t iSize, Mode eMode)
+    {
+        uint64_t iCapacity = ShmRing::roundUpPow2(iSize);
+        m_pHdr = ShmRing::createRegion(strName, regionBytes(iCapacity), eMode, iCapacity, sizeof(T));
+        if (!m_pHdr) return false;
+        m_pSlots = (Slot*)((char*)m_pHdr + sizeof(Header));
+        m_iMapBytes = regionBytes(iCapacity);
+        for (uint64_t i=0; i<iCapacity; ++i)
+        {
+            m_pSlots[i].m_iSeq.store(i, std::memory_order_relaxed);
+        }
+        m_iMask = iCapacity - 1;
+        m_pHdr->m_iReady.store(1, std::memory_order_release);
+        return true;
+    }
+
+    //Maps an existing object created by another process, validates its header.
+    bool attach(const std::string& strName, int iTimeoutMs = ShmRing::ATTACH_TIMEOUT_MS)
+    {
+        m_pHdr = ShmRing::attachRegion(strName, sizeof(T), m_iMapBytes, iTimeoutMs);
+        if (!m_pHdr) return false;
+        if ((SPSC != m_pHdr->m_eMode && MPMC != m_pHdr->m_eMode) || regionBytes(m_pHdr->m_iCapacity) > m_iMapBytes)
+        {
+            fprintf(stderr, "ShmRingQ %s : not a fixed size item ring\n", strName.c_str());
+            detach();
+            return false;
+        }
+        m_pSlots = (Slot*)((char*)m_pHdr + sizeof(Header));
+        m_iMask = m_pHdr->m_iCapacity - 1;
+        m_iCachedHead = m_pHdr->m_iHead.load(std::memory_order_acquire);
+        m_iCachedTail = m_pHdr->m_iTail.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void detach()
+    {
+        if (m_pHdr) { munmap(m_pHdr, m_iMapBytes); m_pHdr = NULL; m_pSlots = NULL; }
+    }
+
+    //Removes the name, mappings stay valid until every process detaches.
+    static bool unlink(const std::string& strName) { return 0 == shm_unlink(strName.c_str()); }
+
+    inline Mode getMode() const { return (Mode)m_pHdr->m_eMode; }
+    inline size_t getSize() const { return m_pHdr->m_iCapacity; }
+    inline size_t getCount() const
+    {
+        uint64_t iHead = m_pHdr->m_iHead.load(std::memory_order_acquire);
+        uint64_t iTail = m_pHdr->m_iTail.load(std::memory_order_acquire);
+        return (iTail > iHead) ? iTail - iHead : 0;
+    }
+    inline bool isEmpty() const { return 0 == getCount(); }
+    inline bool isFull() const { return getCount() >= getSize(); }
+
+    bool tryEnqueue(const T& val)
+    {
+        if (SPSC == m_pHdr->m_eMode)
+        {
+            uint64_t iTail = m_pHdr->m_iTail.load(std::memory_order_relaxed);
+            if (iTail - m_iCachedHead > m_iMask)
+            {
+                m_iCachedHead = m_pHdr->m_iHead.load(std::memory_order_acquire);
+                if (iTail - m_iCachedHead > m_iMask) return false;
+            }
+            m_pSlots[iTail & m_iMask].m_value = val;
+            m_pHdr->m_iTail.store(iTail + 1, std::memory_order_release);
+        }
+        else
+        {
+            uint64_t iPos = m_pHdr->m_iTail.load(std::memory_order_relaxed);
+            Slot* pSlot;
+            while (true)
+            {
+                pSlot = &m_pSlots[iPos & m_iMask];
+                uint64_t iSeq = pSlot->m_iSeq.load(std::memory_order_acquire);
+                int64_t iDiff = (int64_t)iSeq - (int64_t)iPos;
+                if (0 == iDiff)
+                {
+                    if (m_pHdr->m_iTail.compare_exchange_weak(iPos, iPos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (iDiff < 0)
+                {
+                    return false;                   //Slot still holds last lap's item, full.
+                }
+                else
+                {
+                    iPos = m_pHdr->m_iTail.load(std::memory_order_relaxed);
+                }
+            }
+            pSlot->m_value = val;
+            pSlot->m_iSeq.store(iPos + 1, std::memory_order_release);
+        }
+        ShmRing::signal(m_pHdr->m_iNotEmpty, m_pHdr->m_iWaitingConsumers);
+        return true;
+    }
+
+    bool tryDequeue(T& val)
+    {
+        if (SPSC == m_pHdr->m_eMode)
+        {
+            uint64_t iHead = m_pHdr->m_iHead.load(std::memory_order_relaxed);
+            if (iHead == m_iCachedTail)
+            {
+                m_iCachedTail = m_pHdr->m_iTail.load(std::memory_order_acquire);
+                if (iHead == m_iCachedTail) return false;
+            }
+            val = m_pSlots[iHead & m_iMask].m_value;
+            m_pHdr->m_iHead.store(iHead + 1, std::memory_order_release);
+        }
+        else
+        {
+            uint64_t iPos = m_pHdr->m_iHead.load(std::memory_order_relaxed);
+            Slot* pSlot;
+            while (true)
+            {
+                pSlot = &m_pSlots[iPos & m_iMask];
+                uint64_t iSeq = pSlot->m_iSeq.load(std::memory_order_acquire);
+                int64_t iDiff = (int64_t)iSeq - (int64_t)(iPos + 1);
+                if (0 == iDiff)
+                {
+                    if (m_pHdr->m_iHead.compare_exchange_weak(iPos, iPos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (iDiff < 0)
+                {
+                    return false;                   //Nothing written for this lap yet, empty.
+                }
+                else
+                {
+                    iPos = m_pHdr->m_iHead.load(std::memory_order_relaxed);
+                }
+            }
+            val = pSlot->m_value;
+            pSlot->m_iSeq.store(iPos + m_iMask + 1, std::memory_order_release);
+        }
+        ShmRing::signal(m_pHdr->m_iNotFull, m_pHdr->m_iWaitingProducers);
+        return true;
+    }
+
+    //Blocks while full.
+    void enqueue(const T& val)
+    {
+        ShmRing::waitFor(m_pHdr->m_iNotFull, m_pHdr->m_iWaitingProducers, [&]() { return tryEnqueue(val); });
+    }
+
+    //Blocks while empty.
+    void dequeue(T& val)
+    {
+        ShmRing::waitFor(m_pHdr->m_iNotEmpty, m_pHdr->m_iWaitingConsumers, [&]() { return tryDequeue(val); });
+    }
+};
+
+
+/*
+Variable length records (16 B .. few KB), single producer & single consumer process.
+Ring is a byte array, every record is  [ length u32 | flag u32 | payload ]  padded to 8 bytes.
+A record is always contiguous, when it does not fit before the end of the ring the rest of
+the ring is filled with one PAD record and the record starts at offset 0, the consumer skips
+PAD records. Max record payload = capacity / 2 so padding can never make a record unfittable.
+
+Zero copy API, no allocation or memcpy per message...
+    char* p = q.reserve(iMaxLen);     p == NULL -> full (or use reserveBlocking)
+    ... serialize into p ...
+    q.commit(iUsedLen);               iUsedLen <= iMaxLen, publishes the record
+
+    size_t iLen;
+    const char* p = q.peek(iLen);     p == NULL -> empty (or use peekBlocking)
+    ... parse in place ...
+    q.release();                      gives the bytes back to the producer
+Head & tail are byte offsets that only grow, offset & mask is the position in the ring.
+*/
+class ShmByteRingQ
+{
+    private:
+    typedef ShmRing::Header Header;
+
+    struct RecordHdr
+    {
+        uint32_t m_iLen;
+        uint32_t m_iFlag;
+    };
+    static constexpr uint32_t FLAG_DATA = 0, FLAG_PAD = 1;
+
+    Header *m_pHdr;
+    char *m_pData;
+    size_t m_iMapBytes;
+    uint64_t m_iMask;
+    uint64_t m_iCachedHead, m_iCachedTail;
+    uint64_t m_iReserved;                       //Producer, byte offset of the reserved record.
+    uint64_t m_iPeeked;                         //Consumer, byte offset after the peeked record.
+
+    static inline uint64_t recordBytes(size_t iLen) { return (sizeof(RecordHdr) + iLen + 7) & ~(uint64_t)7; }
+    inline RecordHdr* recordAt(uint64_t iOffset) const { return (RecordHdr*)(m_pData + (iOffset & m_iMask)); }
+
+    public:
+    ShmByteRingQ() : m_pHdr{NULL}, m_pData{NULL}, m_iMapBytes{0}, m_iMask{0}, m_iCachedHead{0},
+                     m_iCachedTail{0}, m_iReserved{0}, m_iPeeked{0} {}
+    ShmByteRingQ(const ShmByteRingQ&) = delete;
+    ShmByteRingQ& operator=(const ShmByteRingQ&) = delete;
+    ~ShmByteRingQ() { detach(); }
+
+    bool create(const std::string& strName, size_t iBytes)
+    {
+        uint64_t iCapacity = ShmRing::roundUpPow2(std::max<size_t>(iBytes, 64));
+        m_pHdr = ShmRing::createRegion(strName, sizeof(Header) + iCapacity, ShmRing::BYTES, iCapacity, 0);
+        if (!m_pHdr) return false;
+        m_iMapBytes = sizeof(Header) + iCapacity;
+        m_pData = (char*)m_pHdr + sizeof(Header);
+        m_iMask = iCapacity - 1;
+        m_pHdr->m_iReady.store(1, std::memory_order_release);
+        return true;
+    }
+
+    bool attach(const std::string& strName, int iTimeoutMs = ShmRing::ATTACH_TIMEOUT_MS)
+    {
+        m_pHdr = ShmRing::attachRegion(strName, 0, m_iMapBytes, iTimeoutMs);
+        if (!m_pHdr) return false;
+        if (ShmRing::BYTES != m_pHdr->m_eMode || sizeof(Header) + m_pHdr->m_iCapacity > m_iMapBytes)
+        {
+            fprintf(stderr, "ShmByteRingQ %s : not a byte ring\n", strName.c_str());
+            detach();
+            return false;
+        }
+        m_pData = (char*)m_pHdr + sizeof(Header);
+        m_iMask = m_pHdr->m_iCapacity - 1;
+        m_iCachedHead = m_pHdr->m_iHead.load(std::memory_order_acquire);
+        m_iCachedTail = m_pHdr->m_iTail.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void detach()
+    {
+        if (m_pHdr) { munmap(m_pHdr, m_iMapBytes); m_pHdr = NULL; m_pData = NULL; }
+    }
+    static bool unlink(const std::string& strName) { return 0 == shm_unlink(strName.c_str()); }
+
+    inline size_t getSize() const { return m_pHdr->m_iCapacity; }
+    inline size_t maxRecord() const { return m_pHdr->m_iCapacity / 2 - sizeof(RecordHdr); }
+
+    /*
+    Reserves iMaxLen contiguous payload bytes, NULL when the ring has no room right now.
+    Only one reservation may be open, it is published by commit().
+    */
+    char* reserve(size_t iMaxLen)
+    {
+        if (iMaxLen > maxRecord()) return NULL;
+        uint64_t iTail = m_pHdr->m_iTail.load(std::memory_order_relaxed);
+        uint64_t iNeed = recordBytes(iMaxLen);
+        uint64_t iToEnd = m_pHdr->m_iCapacity - (iTail & m_iMask);
+        uint64_t iPad = (iToEnd < iNeed) ? iToEnd : 0;
+
+        if (iTail + iPad + iNeed - m_iCachedHead > m_pHdr->m_iCapacity)
+        {
+            m_iCachedHead = m_pHdr->m_iHead.load(std::memory_order_acquire);
+            if (iTail + iPad + iNeed - m_iCachedHead > m_pHdr->m_iCapacity) return NULL;
+        }
+        if (iPad)
+        {
+            RecordHdr* pPad = recordAt(iTail);  //Consumer can't see it before the commit moves tail.
+            pPad->m_iLen = (uint32_t)(iPad - sizeof(RecordHdr));
+            pPad->m_iFlag = FLAG_PAD;
+        }
+        m_iReserved = iTail + iPad;
+        return (char*)(recordAt(m_iReserved) + 1);
+    }
+
+    //Publishes the reserved record with its real length (<= reserved length).
+    void commit(size_t iLen)
+    {
+        RecordHdr* pRec = recordAt(m_iReserved);
+        pRec->m_iLen = (uint32_t)iLen;
+        pRec->m_iFlag = FLAG_DATA;
+        m_pHdr->m_iTail.store(m_iReserved + recordBytes(iLen), std::memory_order_release);
+        ShmRing::signal(m_pHdr->m_iNotEmpty, m_pHdr->m_iWaitingConsumers);
+    }
+
+    //Next record's payload in place & its length, NULL when empty. Stays valid until release().
+    const char* peek(size_t& iLen)
+    {
+        uint64_t iHead = m_pHdr->m_iHead.load(std::memory_order_relaxed);
+        for (int i=0; i<2; ++i)                 //At most one PAD record before a real one.
+        {
+            if (iHead == m_iCachedTail)
+            {
+                m_iCachedTail = m_pHdr->m_iTail.load(std::memory_order_acquire);
+                if (iHead == m_iCachedTail) return NULL;
+            }
+            RecordHdr* pRec = recordAt(iHead);
+            if (FLAG_PAD == pRec->m_iFlag)
+            {
+                iHead += recordBytes(pRec->m_iLen);
+                continue;
+            }
+            iLen = pRec->m_iLen;
+            m_iPeeked = iHead + recordBytes(iLen);
+            return (const char*)(pRec + 1);
+        }
+        return NULL;
+    }
+
+    //Frees the record returned by the last peek().
+    void release()
+    {
+        m_pHdr->m_iHead.store(m_iPeeked, std::memory_order_release);
+        ShmRing::signal(m_pHdr->m_iNotFull, m_pHdr->m_iWaitingProducers);
+    }
+
+    char* reserveBlocking(size_t iMaxLen)
+    {
+        if (iMaxLen > maxRecord()) return NULL;
+        char* p = NULL;
+        ShmRing::waitFor(m_pHdr->m_iNotFull, m_pHdr->m_iWaitingProducers, [&]() { return NULL != (p = reserve(iMaxLen)); });
+        return p;
+    }
+
+    const char* peekBlocking(size_t& iLen)
+    {
+        const char* p = NULL;
+        ShmRing::waitFor(m_pHdr->m_iNotEmpty, m_pHdr->m_iWaitingConsumers, [&]() { return NULL != (p = peek(iLen)); });
+        return p;
+    }
+
+    //Copying convenience for callers that already have the bytes.
+    bool tryPush(const void* pData, size_t iLen)
+    {
+        char* p = reserve(iLen);
+        if (!p) return false;
+        memcpy(p, pData, iLen);
+        commit(iLen);
+        return true;
+    }
+};
+
+#endif
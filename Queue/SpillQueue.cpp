@@ -0,0 +1,195 @@
+#include <bits/stdc++.h>
+#include <sys/wait.h>
+#include "SpillQueue.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+SpillQueue tests.
+    backpressure  Fast producers, slowed consumers, memory must stay near the high watermark
+                  while every item arrives exactly once and in per producer order. Memory is
+                  checked twice: the queue's own in memory count and the growth of the process
+                  RSS, which also catches nodes the in memory tier never frees.
+    persistent    Fill past the watermark, consume part, destroy the queue, open a new one on
+                  the same directory, the rest must come back in order and nothing more.
+    crash         Same, but a child process fills, consumes part and _exits without the
+                  destructor. What comes back must be in order and never an item the child
+                  consumed (items only in memory at the crash are lost, see SpillQueue.h).
+Items are (producer << 40 | sequence) so order & duplicates can be checked.
+
+Compile: g++ -O3 -std=c++17 -pthread SpillQueue.cpp
+Run    : ./a.out [items per producer (default 2M)] [producers] [consumers] [spill dir]
+*/
+
+const int SEQ_BITS = 40;
+const lli RSS_BUDGET = 64 << 20;               //Watermark worth of nodes, batches & thread stacks.
+
+//Resident set of the whole process in bytes, 0 if /proc isn't there.
+lli residentBytes()
+{
+    long lPages = 0, lResident = 0;
+    FILE* pFile = fopen("/proc/self/statm", "r");
+    if (pFile)
+    {
+        if (2 != fscanf(pFile, "%ld %ld", &lPages, &lResident)) lResident = 0;
+        fclose(pFile);
+    }
+    return (lli)lResident * sysconf(_SC_PAGESIZE);
+}
+
+bool runBackpressure(lli iItems, int iProducers, int iConsumers, const string& strDir)
+{
+    SpillQueue<lli>::Config config;
+    config.m_strDir = strDir;
+    config.m_iHighWatermark = 100'000;
+    config.m_iBatchItems = 16'384;
+    config.m_iSegmentBytes = 4 << 20;
+    config.m_iFsyncEvery = 8;
+    SpillQueue<lli> q(config);
+
+    lli iTotal = iItems * iProducers;
+    vector<atomic<char>> vecSeen(iTotal);
+    for (auto& c : vecSeen) c.store(0, memory_order_relaxed);
+    atomic<lli> iReceived{0}, iBad{0}, iPeakMemory{0};
+    atomic<bool> bDone{false};
+    lli iBaseRss = residentBytes(), iPeakRss = iBaseRss;
+
+    auto startTime = high_resolution_clock::now();
+    thread monitor([&]()
+    {
+        while (!bDone.load(memory_order_acquire))
+        {
+            lli iMem = q.getInMemory();
+            if (iMem > iPeakMemory.load(memory_order_relaxed)) iPeakMemory.store(iMem, memory_order_relaxed);
+            iPeakRss = max(iPeakRss, residentBytes());
+            this_thread::sleep_for(microseconds(200));
+        }
+    });
+    vector<thread> vecThreads;
+    for (int p=0; p<iProducers; ++p)
+    {
+        vecThreads.emplace_back([&, p]()
+        {
+            for (lli i=0; i<iItems; ++i)
+            {
+                if (!q.enqueue(((lli)p << SEQ_BITS) | i)) { iBad.fetch_add(1); return; }
+            }
+        });
+    }
+    for (int c=0; c<iConsumers; ++c)
+    {
+        vecThreads.emplace_back([&]()
+        {
+            vector<lli> vecLast(iProducers, -1);
+            lli iVal, iMine = 0;
+            while (iReceived.load(memory_order_relaxed) < iTotal)
+            {
+                if (!q.dequeue(iVal)) continue;
+                int p = (int)(iVal >> SEQ_BITS);
+                lli iSeq = iVal & ((1LL << SEQ_BITS) - 1);
+                if (iSeq <= vecLast[p] || vecSeen[p * iItems + iSeq].exchange(1)) iBad.fetch_add(1);
+                vecLast[p] = iSeq;
+                iReceived.fetch_add(1, memory_order_relaxed);
+                if (0 == ++iMine % 4096) this_thread::sleep_for(microseconds(500));   //Slow consumer.
+            }
+        });
+    }
+    for (auto& t : vecThreads) t.join();
+    bDone.store(true, memory_order_release);
+    monitor.join();
+    double dSec = duration_cast<microseconds>(high_resolution_clock::now() - startTime).count() / 1e6;
+
+    lli iRssGrowth = iPeakRss - iBaseRss;
+    bool bOk = (0 == iBad) && (iReceived == iTotal) && (0 == q.getBacklog()) && (iRssGrowth <= RSS_BUDGET);
+    cout << "backpressure : " << iProducers << "P + " << iConsumers << "C, " << iReceived << " / " << iTotal
+         << " items in " << dSec << " s, spilled " << q.getSpilled() << ", peak in memory " << iPeakMemory
+         << " (watermark " << config.m_iHighWatermark << "), peak RSS +" << iRssGrowth / (1 << 20)
+         << " MB (budget " << RSS_BUDGET / (1 << 20) << ") -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+bool runPersistent(const string& strDir)
+{
+    SpillQueue<lli>::Config config;
+    config.m_strDir = strDir;
+    config.m_iHighWatermark = 50'000;
+    config.m_iBatchItems = 8'192;
+    config.m_iSegmentBytes = 1 << 20;
+    config.m_bPersistent = true;
+
+    const lli ITEMS = 300'000, FIRST_PART = 70'000;
+    bool bOk = true;
+    {
+        SpillQueue<lli> q(config);
+        for (lli i=0; i<ITEMS; ++i) bOk &= q.enqueue(i);
+        lli iVal;
+        for (lli i=0; i<FIRST_PART; ++i) bOk &= q.dequeue(iVal) && (iVal == i);
+    }
+    lli iNext = FIRST_PART, iVal;
+    {
+        SpillQueue<lli> q(config);
+        while (q.dequeue(iVal)) bOk &= (iVal == iNext++);
+        bOk &= !q.isSpilling();
+        config.m_bPersistent = false;           //Nothing left, let the second queue clean up.
+    }
+    bOk &= (ITEMS == iNext);
+    cout << "persistent   : " << FIRST_PART << " read before restart, " << iNext - FIRST_PART
+         << " after -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+bool runCrash(const string& strDir)
+{
+    SpillQueue<lli>::Config config;
+    config.m_strDir = strDir;
+    config.m_iHighWatermark = 50'000;
+    config.m_iBatchItems = 8'192;
+    config.m_iSegmentBytes = 1 << 20;
+    config.m_bPersistent = true;
+
+    const lli ITEMS = 300'000, FIRST_PART = 150'000;   //Part of it comes back from disk.
+    fflush(stdout);
+    pid_t pid = fork();
+    if (0 == pid)
+    {
+        SpillQueue<lli>* pQ = new SpillQueue<lli>(config);     //Never destroyed, the "crash".
+        bool bOk = true;
+        for (lli i=0; i<ITEMS; ++i) bOk &= pQ->enqueue(i);
+        lli iVal;
+        for (lli i=0; i<FIRST_PART; ++i) bOk &= pQ->dequeue(iVal) && (iVal == i);
+        _exit(bOk ? 0 : 1);
+    }
+    int iStatus = -1;
+    bool bOk = (pid > 0) && (pid == waitpid(pid, &iStatus, 0)) && WIFEXITED(iStatus) && (0 == WEXITSTATUS(iStatus));
+
+    lli iVal, iLast = FIRST_PART - 1, iCount = 0;
+    {
+        SpillQueue<lli> q(config);                  //Resumes, removes the drained segments.
+        while (q.dequeue(iVal))
+        {
+            bOk &= (iVal > iLast);
+            iLast = iVal;
+            ++iCount;
+        }
+    }
+    cout << "crash        : " << FIRST_PART << " read before the crash, " << iCount
+         << " recovered, none of them again -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+int main(int argc, char** argv)
+{
+    lli iItems = (argc > 1) ? atoll(argv[1]) : 2'000'000;
+    int iProducers = (argc > 2) ? atoi(argv[2]) : 4;
+    int iConsumers = (argc > 3) ? atoi(argv[3]) : 2;
+    string strDir = (argc > 4) ? argv[4] : "/tmp/spill_q_test";
+
+    bool bOk = runBackpressure(iItems, iProducers, iConsumers, strDir);
+    bOk = runPersistent(strDir + "_persistent") && bOk;
+    bOk = runCrash(strDir + "_crash") && bOk;
+    rmdir(strDir.c_str());
+    rmdir((strDir + "_persistent").c_str());
+    rmdir((strDir + "_crash").c_str());
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+#ifndef QUEUE_SPILL_QUEUE_H
+#define QUEUE_SPILL_QUEUE_H
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "LockFreeQueue.h"
+
+
+/*
+Queue with a persistent write-ahead spill, memory stays bounded when consumers fall behind.
+
+    in memory (MemQueue)  ->  consumers
+         ^                       ^ refill, one batch when memory ran empty
+    producers --(above high watermark / MemQueue full)--> write batch --> segment files
+
+While occupancy is below the high watermark items go straight into MemQueue (LockFreeQueue by
+default, any bounded queue whose enqueue returns false when full works too). Past it the queue
+switches to spilling: every new item is appended to a write batch, full batches go to the
+current segment file with one large sequential write, a segment is closed at SEGMENT_BYTES and
+a new one started. A consumer that finds memory empty reads the next batch back (oldest
+segment first, then the unflushed write batch) into memory, a segment read to its end is
+deleted. Once disk and write batch are empty the queue stops spilling.
+Order: while spilling no producer writes memory, so per producer FIFO order is kept.
+
+Durability (Config::m_bPersistent): the destructor writes what is still in memory to a segment
+in front of the others, flushes the write batch and stores the read position (spill.head), a
+new SpillQueue on the same directory resumes from there in the same order. With
+m_iFsyncEvery = N every N-th batch write is followed by fdatasync, 0 leaves flushing to the
+kernel. spill.head is also rewritten (temp file + rename) every time a batch moves from disk
+into memory, so after a crash the segments resume behind the last batch read back and no
+consumed batch is replayed. What was only in memory at the crash (items never spilled, or a
+refilled batch not fully dequeued) and the unwritten batch are lost: recovery after a crash
+is at most once, a clean shutdown loses nothing.
+The disk path is serialized by one mutex, the memory path stays lock-free.
+T must be trivially copyable, records are its raw bytes.
+*/
+
+template<typename T, typename MemQueue = LockFreeQueue<T>>
+class SpillQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Spilled records are raw bytes of T");
+
+    public:
+    struct Config
+    {
+        std::string m_strDir = "spill";
+        size_t m_iHighWatermark = 1 << 20;      //Items in memory before spilling starts.
+        size_t m_iBatchItems = 1 << 16;         //Items per disk write / refill.
+        size_t m_iSegmentBytes = 64 << 20;
+        int m_iFsyncEvery = 0;                  //fdatasync every N batch writes, 0 = never.
+        bool m_bPersistent = false;             //Keep & resume segments instead of deleting them.
+    };
+
+    private:
+        static constexpr uint64_t FIRST_SEGMENT_ID = 1'000'000;   //Room to prepend segments on shutdown.
+
+        struct Segment
+        {
+            uint64_t m_iId;
+            int m_fd;
+            uint64_t m_iWritten, m_iRead;       //Bytes.
+        };
+
+        MemQueue m_mem;
+        alignas(64) std::atomic<long long> m_iInMemory;
+        alignas(64) std::atomic<bool> m_bSpilling;
+
+        Config m_config;
+        std::mutex m_mutex;                     //Everything below.
+        std::vector<T> m_writeBatch, m_readBatch;
+        std::deque<Segment> m_segments;
+        uint64_t m_iNextId;
+        uint64_t m_iBatchWrites;
+        uint64_t m_iSpilled;
+        bool m_bIoError;
+
+        std::string segmentPath(uint64_t iId) const
+        {
+            char szName[32];
+            snprintf(szName, sizeof(szName), "/spill-%08llu.log", (unsigned long long)iId);
+            return m_config.m_strDir + szName;
+        }
+        std::string headPath() const { return m_config.m_strDir + "/spill.head"; }
+
+        //Read position for resume(), replaced atomically so a crash leaves the old or the new one.
+        void saveHead(uint64_t iHeadId, uint64_t iHeadPos)
+        {
+            std::string strTmp = headPath() + ".tmp";
+            FILE* pHead = fopen(strTmp.c_str(), "w");
+            if (!pHead) { ioError("open", strTmp); return; }
+            fprintf(pHead, "%llu %llu\n", (unsigned long long)iHeadId, (unsigned long long)iHeadPos);
+            if (0 != fflush(pHead) || (m_config.m_iFsyncEvery > 0 && 0 != fdatasync(fileno(pHead)))) ioError("write", strTmp);
+            fclose(pHead);
+            if (0 != rename(strTmp.c_str(), headPath().c_str())) ioError("rename", headPath());
+        }
+
+        bool ioError(const char* pszWhat, const std::string& strPath)
+        {
+            fprintf(stderr, "SpillQueue %s %s : %s\n", pszWhat, strPath.c_str(), strerror(errno));
+            m_bIoError = true;
+            return false;
+        }
+
+        bool openSegment(uint64_t iId, bool bCreate)
+        {
+            std::string strPath = segmentPath(iId);
+            int fd = open(strPath.c_str(), O_RDWR | (bCreate ? O_CREAT | O_TRUNC : 0), 0644);
+            if (fd < 0) return ioError("open", strPath);
+            uint64_t iSize = 0;
+            if (!bCreate)
+            {
+                struct stat st;
+                if (0 != fstat(fd, &st)) { close(fd); return ioError("stat", strPath); }
+                iSize = (uint64_t)st.st_size / sizeof(T) * sizeof(T);   //Drop a torn last record.
+            }
+            Segment seg{iId, fd, iSize, 0};
+            if (!m_segments.empty() && iId < m_segments.front().m_iId) m_segments.push_front(seg);
+            else m_segments.push_back(seg);
+            m_iNextId = std::max(m_iNextId, iId + 1);
+            return true;
+        }
+
+        void dropFrontSegment()
+        {
+            Segment& seg = m_segments.front();
+            close(seg.m_fd);
+            if (0 != unlink(segmentPath(seg.m_iId).c_str())) ioError("unlink", segmentPath(seg.m_iId));
+            m_segments.pop_front();
+        }
+
+        bool writeAll(Segment& seg, const std::vector<T>& vecItems)
+        {
+            const char* p = (const char*)vecItems.data();
+            size_t iBytes = vecItems.size() * sizeof(T);
+            while (iBytes > 0)
+            {
+                ssize_t iDone = pwrite(seg.m_fd, p, iBytes, (off_t)seg.m_iWritten);
+                if (iDone < 0 && EINTR == errno) continue;
+                if (iDone <= 0) return ioError("write", segmentPath(seg.m_iId));
+                p += iDone;
+                iBytes -= iDone;
+                seg.m_iWritten += iDone;
+            }
+            return true;
+        }
+
+        //One large sequential write of the whole batch, new segment when the current is full.
+        bool flushBatch()
+        {
+            if (m_writeBatch.empty()) return true;
+            if (m_segments.empty() || m_segments.back().m_iWritten >= m_config.m_iSegmentBytes)
+            {
+                if (!openSegment(m_iNextId, true)) return false;
+            }
+            Segment& seg = m_segments.back();
+            if (!writeAll(seg, m_writeBatch)) return false;
+            m_writeBatch.clear();
+            if (m_config.m_iFsyncEvery > 0 && 0 == ++m_iBatchWrites % m_config.m_iFsyncEvery)
+            {
+                if (0 != fdatasync(seg.m_fd)) return ioError("fdatasync", segmentPath(seg.m_iId));
+            }
+            return true;
+        }
+
+        //Next batch in FIFO order into m_readBatch: oldest segment, else the unwritten batch.
+        bool readBatch()
+        {
+            m_readBatch.clear();
+            while (!m_segments.empty())
+            {
+                Segment& seg = m_segments.front();
+                if (seg.m_iRead < seg.m_iWritten)
+                {
+                    size_t iItems = std::min<uint64_t>(m_config.m_iBatchItems, (seg.m_iWritten - seg.m_iRead) / sizeof(T));
+                    m_readBatch.resize(iItems);
+                    ssize_t iDone = pread(seg.m_fd, m_readBatch.data(), iItems * sizeof(T), (off_t)seg.m_iRead);
+                    if (iDone < 0) { m_readBatch.clear(); return ioError("read", segmentPath(seg.m_iId)); }
+                    m_readBatch.resize((size_t)iDone / sizeof(T));
+                    seg.m_iRead += m_readBatch.size() * sizeof(T);
+                    if (!m_readBatch.empty()) return true;
+                }
+                if (m_segments.size() > 1 || m_writeBatch.empty()) dropFrontSegment();
+                else break;                     //Last segment stays open for the next flush.
+            }
+            m_readBatch.swap(m_writeBatch);
+            return true;
+        }
+
+        bool spill(const T& value)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_bIoError) return false;
+            m_bSpilling.store(true, std::memory_order_release);
+            m_writeBatch.push_back(value);
+            ++m_iSpilled;
+            return (m_writeBatch.size() < m_config.m_iBatchItems) || flushBatch();
+        }
+
+        /*
+        Memory ran empty for this consumer, under the lock: memory first (an item may have
+        landed there since, it is older than anything on disk), else the next batch from disk.
+        */
+        bool refill(T& result)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_mem.dequeue(result))
+            {
+                m_iInMemory.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (!m_bSpilling.load(std::memory_order_relaxed) || !readBatch()) return false;
+            if (m_readBatch.empty())
+            {
+                m_bSpilling.store(false, std::memory_order_release);   //Disk caught up.
+                return false;
+            }
+            for (const T& value : m_readBatch)
+            {
+                //A full bounded MemQueue can't happen here, memory was empty and batch <= watermark.
+                m_mem.enqueue(value);
+            }
+            m_iInMemory.fetch_add((long long)m_readBatch.size(), std::memory_order_release);
+            if (m_config.m_bPersistent)
+            {
+                //The batch left the disk, a restart after a crash must not hand it out again.
+                saveHead(m_segments.empty() ? 0 : m_segments.front().m_iId,
+                         m_segments.empty() ? 0 : m_segments.front().m_iRead);
+            }
+            if (!m_mem.dequeue(result)) return false;
+            m_iInMemory.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void resume()
+        {
+            DIR* pDir = opendir(m_config.m_strDir.c_str());
+            if (!pDir) return;
+            std::vector<uint64_t> vecIds;
+            while (struct dirent* pEntry = readdir(pDir))
+            {
+                unsigned long long iId;
+                if (1 == sscanf(pEntry->d_name, "spill-%llu.log", &iId)) vecIds.push_back(iId);
+            }
+            closedir(pDir);
+            std::sort(vecIds.begin(), vecIds.end());
+            for (uint64_t iId : vecIds) openSegment(iId, false);
+
+            FILE* pHead = fopen(headPath().c_str(), "r");
+            unsigned long long iHeadId = 0, iHeadPos = 0;
+            if (pHead)
+            {
+                if (2 == fscanf(pHead, "%llu %llu", &iHeadId, &iHeadPos))
+                {
+                    for (Segment& seg : m_segments)
+                    {
+                        if (seg.m_iId == iHeadId) seg.m_iRead = std::min<uint64_t>(iHeadPos, seg.m_iWritten);
+                    }
+                }
+                fclose(pHead);
+            }
+            if (!m_segments.empty()) m_bSpilling.store(true, std::memory_order_release);
+        }
+
+    public:
+    explicit SpillQueue(const Config& config = Config()) : m_iInMemory{0}, m_bSpilling{false}, m_config(config),
+                                                           m_iNextId{FIRST_SEGMENT_ID}, m_iBatchWrites{0}, m_iSpilled{0}, m_bIoError{false}
+    {
+        m_config.m_iBatchItems = std::max<size_t>(1, std::min(m_config.m_iBatchItems, m_config.m_iHighWatermark));
+        m_writeBatch.reserve(m_config.m_iBatchItems);
+        if (0 != mkdir(m_config.m_strDir.c_str(), 0755) && EEXIST != errno) ioError("mkdir", m_config.m_strDir);
+        if (m_config.m_bPersistent) resume();
+    }
+    SpillQueue(const SpillQueue&) = delete;
+    SpillQueue& operator=(const SpillQueue&) = delete;
+
+    ~SpillQueue()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_config.m_bPersistent)
+        {
+            //Memory holds the oldest items, they go to a segment in front of the unread ones.
+            std::vector<T> vecMem;
+            T value;
+            while (m_mem.dequeue(value)) vecMem.push_back(value);
+            uint64_t iHeadId = m_segments.empty() ? 0 : m_segments.front().m_iId;
+            uint64_t iHeadPos = m_segments.empty() ? 0 : m_segments.front().m_iRead;
+            if (!vecMem.empty())
+            {
+                uint64_t iId = m_segments.empty() ? m_iNextId : m_segments.front().m_iId - 1;
+                if (openSegment(iId, true) && writeAll(m_segments.front(), vecMem)) fdatasync(m_segments.front().m_fd);
+            }
+            flushBatch();
+            if (!m_segments.empty())
+            {
+                fdatasync(m_segments.back().m_fd);
+                saveHead(iHeadId, iHeadPos);
+            }
+            else unlink(headPath().c_str());
+            for (Segment& seg : m_segments) close(seg.m_fd);
+            return;
+        }
+        while (!m_segments.empty()) dropFrontSegment();
+        unlink(headPath().c_str());             //Left by an earlier persistent run.
+    }
+
+    //False only after a disk error, the item is not queued then.
+    bool enqueue(const T& value)
+    {
+        if (!m_bSpilling.load(std::memory_order_acquire))
+        {
+            if (m_iInMemory.fetch_add(1, std::memory_order_relaxed) < (long long)m_config.m_iHighWatermark &&
+                m_mem.enqueue(value))
+            {
+                return true;
+            }
+            m_iInMemory.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return spill(value);
+    }
+
+    bool dequeue(T& result)
+    {
+        if (m_mem.dequeue(result))
+        {
+            m_iInMemory.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (!m_bSpilling.load(std::memory_order_acquire)) return false;
+        return refill(result);
+    }
+
+    inline bool isSpilling() const { return m_bSpilling.load(std::memory_order_relaxed); }
+    inline long long getInMemory() const { return m_iInMemory.load(std::memory_order_relaxed); }
+
+    //Items that went through the disk path so far.
+    uint64_t getSpilled()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_iSpilled;
+    }
+
+    //Spilled items not yet read back, on disk plus the unwritten batch.
+    uint64_t getBacklog()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t iBytes = 0;
+        for (const Segment& seg : m_segments) iBytes += seg.m_iWritten - seg.m_iRead;
+        return iBytes / sizeof(T) + m_writeBatch.size();
+    }
+};
+
+#endif
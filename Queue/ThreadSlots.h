@@ -0,0 +1,62 @@
+#ifndef QUEUE_THREAD_SLOTS_H
+#define QUEUE_THREAD_SLOTS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+
+/*
+Thread ids for the per thread arrays of the reclamation schemes (HazardPointers, EpochManager),
+in [0, MAX) and given back when the thread exits.
+A thread claims the lowest free slot on its first call with a CAS on the slot's owner flag, a
+thread_local guard releases it at thread exit, so a program may create any number of threads
+over its lifetime as long as at most MAX of them use the queues at the same time. Two live
+threads never share a slot: more than MAX live threads is a usage error and aborts instead
+(a shared slot would let one thread clear the other's hazard / epoch, a use after free).
+Every MAX is its own registry, shared by all node types using it.
+*/
+
+template<size_t MAX>
+class ThreadSlots
+{
+    private:
+        static std::atomic<bool> s_bOwned[MAX];
+
+        struct Guard
+        {
+            size_t m_iSlot;
+
+            Guard() : m_iSlot{MAX}
+            {
+                for (size_t i=0; i<MAX; ++i)
+                {
+                    bool bOwned = false;
+                    if (!s_bOwned[i].load(std::memory_order_relaxed) &&
+                        s_bOwned[i].compare_exchange_strong(bOwned, true, std::memory_order_acquire))
+                    {
+                        m_iSlot = i;
+                        return;
+                    }
+                }
+                fprintf(stderr, "ThreadSlots: more than %zu live threads use the queues\n", MAX);
+                abort();
+            }
+
+            //Release, the next owner sees everything this thread did in the slot.
+            ~Guard() { s_bOwned[m_iSlot].store(false, std::memory_order_release); }
+        };
+
+    public:
+    static inline size_t get()
+    {
+        static thread_local Guard guard;
+        return guard.m_iSlot;
+    }
+};
+
+template<size_t MAX>
+std::atomic<bool> ThreadSlots<MAX>::s_bOwned[MAX];
+
+#endif
@@ -0,0 +1,226 @@
+#include <bits/stdc++.h>
+#include "TimingWheel.h"
+using namespace std;
+typedef long long int lli;
+using namespace std::chrono;
+
+/*
+TimingWheel tests & benchmark.
+    check     Random timers (some past the 2^32 tick overflow), a third cancelled, the wheel is
+              advanced in random steps, every live timer must fire exactly once, in the advance
+              that passes its expiry, and in expiry order. One periodic timer re-arms itself.
+    mpsc      Producer threads scheduleAsync while the owner thread advances, nothing lost.
+    race      Producers scheduleAsync the same nodes the owner schedules, every node must be
+              won by exactly one side and fire exactly once.
+    bench     schedule + cancel and schedule + expire per second, against a std::multimap timer
+              (what a heap / tree based timer costs, O(log n) per operation).
+
+Compile: g++ -O3 -std=c++17 -pthread TimingWheel.cpp
+Run    : ./a.out [timers (default 1M)] [producer threads (default 4)]
+*/
+
+bool runCheck(int iTimers, mt19937_64& rng)
+{
+    TimingWheel wheel;
+    vector<unique_ptr<TimerNode>> vecNodes;
+    vector<int> vecFired(iTimers, 0);
+    vector<bool> vecCancelled(iTimers, false);
+    for (int i=0; i<iTimers; ++i)
+    {
+        vecNodes.emplace_back(new TimerNode(i));
+        uint64_t iDelay;
+        switch (rng() % 4)
+        {
+            case 0 : iDelay = rng() % 256; break;
+            case 1 : iDelay = rng() % 65536; break;
+            case 2 : iDelay = rng() % (1 << 24); break;
+            default: iDelay = (0 == i % 1000) ? (1ULL << 32) + rng() % (1ULL << 34) : rng() % (1ULL << 30);
+        }
+        wheel.schedule(*vecNodes[i], iDelay);
+    }
+    for (int i=0; i<iTimers; i+=3)
+    {
+        vecCancelled[i] = wheel.cancel(*vecNodes[i]);
+    }
+
+    TimerNode periodic(UINT64_MAX);
+    const uint64_t PERIOD = 1000;
+    lli iPeriodicFired = 0;
+    wheel.schedule(periodic, PERIOD);
+
+    bool bOk = true;
+    uint64_t iPrevNow = 0, iLastExpiry = 0;
+    uint64_t iEnd = (1ULL << 36) + 1;
+    auto onExpire = [&](TimerNode& node)
+    {
+        if (&node == &periodic)
+        {
+            ++iPeriodicFired;
+            if (node.m_iExpiry + PERIOD < (1ULL << 20)) wheel.schedule(node, node.m_iExpiry + PERIOD);
+            return;
+        }
+        int i = (int)node.m_iData;
+        ++vecFired[i];
+        bool bInWindow = (0 == iPrevNow) || (node.m_iExpiry > iPrevNow);
+        bOk = bOk && !vecCancelled[i] && bInWindow && node.m_iExpiry >= iLastExpiry;
+        iLastExpiry = node.m_iExpiry;
+    };
+    for (uint64_t iNow = 0; iNow < iEnd; )
+    {
+        uint64_t iStep = 1 + ((rng() & 1) ? rng() % 300 : rng() % (1ULL << 28));
+        iNow = min(iEnd, iNow + iStep);
+        iLastExpiry = 0;
+        wheel.advance(iNow, onExpire);
+        bOk = bOk && (iLastExpiry <= iNow);
+        iPrevNow = iNow;
+    }
+    for (int i=0; i<iTimers; ++i)
+    {
+        bOk = bOk && (vecFired[i] == (vecCancelled[i] ? 0 : 1));
+    }
+    bOk = bOk && (0 == wheel.getCount()) && ((lli)((1ULL << 20) / PERIOD) == iPeriodicFired);
+    cout << "check : " << iTimers << " timers, " << count(vecCancelled.begin(), vecCancelled.end(), true)
+         << " cancelled, periodic fired " << iPeriodicFired << " -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+bool runMpsc(int iTimers, int iProducers)
+{
+    TimingWheel wheel;
+    vector<unique_ptr<TimerNode>> vecNodes;
+    for (int i=0; i<iTimers; ++i) vecNodes.emplace_back(new TimerNode(i));
+    atomic<int> iDone{0};
+    atomic<uint64_t> iNowShared{0};             //Producers' clock, the wheel's own is owner only.
+    lli iFired = 0;
+
+    auto startTime = high_resolution_clock::now();
+    vector<thread> vecThreads;
+    for (int p=0; p<iProducers; ++p)
+    {
+        vecThreads.emplace_back([&, p]()
+        {
+            for (int i=p; i<iTimers; i+=iProducers)
+            {
+                wheel.scheduleAsync(*vecNodes[i], iNowShared.load(memory_order_relaxed) + i % 5000);
+            }
+            iDone.fetch_add(1, memory_order_release);
+        });
+    }
+    uint64_t iNow = 0;
+    while (true)
+    {
+        bool bProducersDone = (iDone.load(memory_order_acquire) == iProducers);   //Before the drain.
+        iNow += 64;
+        iNowShared.store(iNow, memory_order_relaxed);
+        iFired += wheel.advance(iNow, [](TimerNode&) {});
+        if (bProducersDone && 0 == wheel.getCount()) break;
+    }
+    for (auto& t : vecThreads) t.join();
+    double dSec = duration_cast<microseconds>(high_resolution_clock::now() - startTime).count() / 1e6;
+
+    bool bOk = (iFired == iTimers);
+    cout << "mpsc  : " << iProducers << " producers, " << iFired << " / " << iTimers << " fired, "
+         << iTimers / dSec / 1e6 << " M timers/s -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+bool runRace(int iTimers, int iProducers)
+{
+    TimingWheel wheel;
+    vector<unique_ptr<TimerNode>> vecNodes;
+    for (int i=0; i<iTimers; ++i) vecNodes.emplace_back(new TimerNode(i));
+    atomic<lli> iAsyncWins{0};
+    lli iOwnerWins = 0, iFired = 0;
+    const uint64_t EXPIRY = 1000;               //Nothing fires before every node was tried.
+
+    vector<thread> vecThreads;
+    for (int p=0; p<iProducers; ++p)
+    {
+        vecThreads.emplace_back([&, p]()
+        {
+            lli iWins = 0;
+            for (int i=p; i<iTimers; i+=iProducers) iWins += wheel.scheduleAsync(*vecNodes[i], EXPIRY);
+            iAsyncWins.fetch_add(iWins);
+        });
+    }
+    for (int i=0; i<iTimers; ++i) iOwnerWins += wheel.schedule(*vecNodes[i], EXPIRY);
+    for (auto& t : vecThreads) t.join();
+    vector<int> vecFired(iTimers, 0);
+    iFired = wheel.advance(EXPIRY, [&](TimerNode& node) { ++vecFired[node.m_iData]; });
+
+    bool bOk = (iOwnerWins + iAsyncWins == iTimers) && (iFired == iTimers) && (0 == wheel.getCount()) &&
+               all_of(vecFired.begin(), vecFired.end(), [](int c) { return 1 == c; });
+    cout << "race  : " << iOwnerWins << " scheduled by the owner, " << iAsyncWins << " async, "
+         << iFired << " / " << iTimers << " fired -> " << (bOk ? "OK" : "FAILED") << endl;
+    return bOk;
+}
+
+void runBench(int iTimers, mt19937_64& rng)
+{
+    vector<uint64_t> vecDelay(iTimers);
+    for (auto& d : vecDelay) d = 1 + rng() % 100'000;     //Typical network timeouts, ms ticks.
+
+    vector<unique_ptr<TimerNode>> vecNodes;
+    for (int i=0; i<iTimers; ++i) vecNodes.emplace_back(new TimerNode(i));
+
+    cout << fixed << setprecision(2);
+    cout << setw(24) << "Mops/s" << setw(15) << "TimingWheel" << setw(15) << "std::multimap" << endl;
+
+    //schedule all, cancel all (request timeouts that are answered in time).
+    TimingWheel wheel;
+    auto t0 = high_resolution_clock::now();
+    for (int i=0; i<iTimers; ++i) wheel.schedule(*vecNodes[i], vecDelay[i]);
+    for (int i=0; i<iTimers; ++i) wheel.cancel(*vecNodes[i]);
+    auto t1 = high_resolution_clock::now();
+
+    multimap<uint64_t, int> mapTimers;
+    vector<multimap<uint64_t, int>::iterator> vecIt(iTimers);
+    auto t2 = high_resolution_clock::now();
+    for (int i=0; i<iTimers; ++i) vecIt[i] = mapTimers.emplace(vecDelay[i], i);
+    for (int i=0; i<iTimers; ++i) mapTimers.erase(vecIt[i]);
+    auto t3 = high_resolution_clock::now();
+
+    double dOps = 2.0 * iTimers;
+    cout << setw(24) << "schedule + cancel"
+         << setw(15) << dOps / duration_cast<nanoseconds>(t1 - t0).count() * 1e3
+         << setw(15) << dOps / duration_cast<nanoseconds>(t3 - t2).count() * 1e3 << endl;
+
+    //schedule all, let all expire tick by tick.
+    lli iSum = 0;
+    t0 = high_resolution_clock::now();
+    for (int i=0; i<iTimers; ++i) wheel.schedule(*vecNodes[i], wheel.getCurrent() + vecDelay[i]);
+    for (uint64_t iNow = wheel.getCurrent(); wheel.getCount(); ++iNow)
+    {
+        wheel.advance(iNow, [&](TimerNode& node) { iSum += node.m_iData; });
+    }
+    t1 = high_resolution_clock::now();
+
+    lli iSumMap = 0;
+    t2 = high_resolution_clock::now();
+    for (int i=0; i<iTimers; ++i) mapTimers.emplace(vecDelay[i], i);
+    for (uint64_t iNow = 0; !mapTimers.empty(); ++iNow)
+    {
+        auto it = mapTimers.begin();
+        for (; it != mapTimers.end() && it->first <= iNow; ++it) iSumMap += it->second;
+        mapTimers.erase(mapTimers.begin(), it);
+    }
+    t3 = high_resolution_clock::now();
+
+    cout << setw(24) << "schedule + expire"
+         << setw(15) << dOps / duration_cast<nanoseconds>(t1 - t0).count() * 1e3
+         << setw(15) << dOps / duration_cast<nanoseconds>(t3 - t2).count() * 1e3
+         << ((iSum == iSumMap) ? "" : "   (sums differ!)") << endl;
+}
+
+int main(int argc, char** argv)
+{
+    int iTimers = (argc > 1) ? atoi(argv[1]) : 1'000'000;
+    int iProducers = (argc > 2) ? atoi(argv[2]) : 4;
+    mt19937_64 rng(42);
+
+    bool bOk = runCheck(min(iTimers, 200'000), rng);
+    bOk = runMpsc(iTimers, iProducers) && bOk;
+    bOk = runRace(iTimers, iProducers) && bOk;
+    runBench(iTimers, rng);
+    return bOk ? 0 : 1;
+}
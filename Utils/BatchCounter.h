@@ -0,0 +1,107 @@
+#ifndef UTILS_BATCH_COUNTER_H
+#define UTILS_BATCH_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+
+/*
+Item counter for the benchmark consumers that stays out of the measurement.
+A shared fetch_add (or a mutex) per dequeued item puts one contended cache line into every
+operation and the benchmark ends up timing its own counter. Here every consumer owns a
+slot on its own cache line, counts in a register and stores the running total into its
+slot once every BATCH items (plain store, the line is never written by anybody else).
+The total is the sum of the slots, exact after the consumers flushed, a lower bound while
+they run (good enough for progress output or a watchdog).
+
+    BatchCounter counter(iConsumers);
+    //consumer c
+    BatchCounter::Local cnt(counter, c);
+    while (...) { if (q.dequeue(v)) cnt.add(); ... }
+    //Local's destructor flushes, after the joins counter.total() is exact.
+
+Termination (FinishFlag) doesn't count at all: producers are joined first, then the flag is
+raised. A consumer looks at it only when a dequeue came back empty. Once it is set every
+enqueue happened before, so the consumer drains until the next empty dequeue and stops.
+The hot loop touches only the queue.
+
+    if (q.dequeue(v)) cnt.add();
+    else if (done.isRaised()) { while (q.dequeue(v)) cnt.add(); break; }
+*/
+
+class BatchCounter
+{
+    public:
+    static constexpr long long BATCH = 4096;
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<long long> m_iCount{0};
+        };
+
+        std::unique_ptr<Slot[]> m_pSlots;
+        size_t m_iSlotCnt;
+
+    public:
+    class Local
+    {
+        private:
+            Slot& m_slot;
+            long long m_iCount;
+            long long m_iLeft;                  //Items until the next publish.
+
+        public:
+        Local(BatchCounter& counter, size_t iSlot)
+            : m_slot(counter.m_pSlots[iSlot]), m_iCount{m_slot.m_iCount.load(std::memory_order_relaxed)}, m_iLeft{BATCH} {}
+        ~Local() { flush(); }
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        inline void add()
+        {
+            ++m_iCount;
+            if (0 == --m_iLeft) flush();
+        }
+
+        inline void flush()
+        {
+            m_slot.m_iCount.store(m_iCount, std::memory_order_release);
+            m_iLeft = BATCH;
+        }
+
+        inline long long get() const { return m_iCount; }
+    };
+
+    explicit BatchCounter(size_t iSlots) : m_pSlots(new Slot[iSlots]), m_iSlotCnt{iSlots} {}
+    BatchCounter(const BatchCounter&) = delete;
+    BatchCounter& operator=(const BatchCounter&) = delete;
+
+    long long total() const
+    {
+        long long iTotal = 0;
+        for (size_t i=0; i<m_iSlotCnt; ++i) iTotal += m_pSlots[i].m_iCount.load(std::memory_order_acquire);
+        return iTotal;
+    }
+
+    void reset()
+    {
+        for (size_t i=0; i<m_iSlotCnt; ++i) m_pSlots[i].m_iCount.store(0, std::memory_order_relaxed);
+    }
+};
+
+
+//Raised once after every producer was joined, read by consumers only on empty dequeues.
+class FinishFlag
+{
+    private:
+        alignas(64) std::atomic<bool> m_bDone{false};
+
+    public:
+    inline void raise() { m_bDone.store(true, std::memory_order_release); }
+    inline void reset() { m_bDone.store(false, std::memory_order_relaxed); }
+    inline bool isRaised() const { return m_bDone.load(std::memory_order_acquire); }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef UTILS_PERF_COUNTER_H
+#define UTILS_PERF_COUNTER_H
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+
+/*
+Hardware / software performance counters via Linux perf_event_open, for the benchmarks.
+Counts cycles, instructions, LLC misses, branch misses and context switches of the calling
+thread and of every thread it creates after the counters are opened (inherit), so open
+them in main before spawning producers / consumers.
+
+    PerfCounters counters;                  //Once, before any thread is created.
+    PerfSample sample;
+    {
+        ScopedPerfCounter scope(counters, sample);
+        ... run threads, join them ...
+    }
+    sample.print(cout, iOps);               //IPC, misses per op, ...
+
+Every event is opened on its own, so a missing PMU (VMs) or perf_event_paranoid only
+disables the events it affects, those print as "n/a" and never fail the benchmark.
+If the kernel refuses to count kernel mode, HW events fall back to user mode only.
+*/
+
+struct PerfSample
+{
+    enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, CONTEXT_SWITCHES, EVENT_CNT };
+
+    long long m_iValue[EVENT_CNT];
+    bool m_bValid[EVENT_CNT];
+
+    PerfSample()
+    {
+        for (int e=0; e<EVENT_CNT; ++e) { m_iValue[e] = 0; m_bValid[e] = false; }
+    }
+
+    inline bool valid(Event e) const { return m_bValid[e]; }
+    inline long long value(Event e) const { return m_iValue[e]; }
+    inline double ipc() const
+    {
+        return (valid(CYCLES) && valid(INSTRUCTIONS) && m_iValue[CYCLES] > 0)
+               ? (double)m_iValue[INSTRUCTIONS] / m_iValue[CYCLES] : -1;
+    }
+
+    //Accumulates repeated runs, an event stays valid only if it was valid every time.
+    PerfSample& operator+=(const PerfSample& other)
+    {
+        for (int e=0; e<EVENT_CNT; ++e)
+        {
+            m_iValue[e] += other.m_iValue[e];
+            m_bValid[e] = m_bValid[e] && other.m_bValid[e];
+        }
+        return *this;
+    }
+
+    static void printHeader(std::ostream& os)
+    {
+        os << std::setw(8) << "IPC" << std::setw(13) << "LLC miss/op"
+           << std::setw(13) << "Br miss/op" << std::setw(11) << "Ctx sw";
+    }
+
+    //One row of columns matching printHeader, per op values use dOps as divisor.
+    void print(std::ostream& os, double dOps) const
+    {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        column(ss, 8, (ipc() >= 0), ipc());
+        ss << std::setprecision(4);
+        column(ss, 13, valid(LLC_MISSES), m_iValue[LLC_MISSES] / dOps);
+        column(ss, 13, valid(BRANCH_MISSES), m_iValue[BRANCH_MISSES] / dOps);
+        ss << std::setprecision(0);
+        column(ss, 11, valid(CONTEXT_SWITCHES), (double)m_iValue[CONTEXT_SWITCHES]);
+        os << ss.str();
+    }
+
+    private:
+    static void column(std::ostream& os, int iWidth, bool bValid, double dVal)
+    {
+        if (bValid) os << std::setw(iWidth) << dVal;
+        else        os << std::setw(iWidth) << "n/a";
+    }
+};
+
+
+class PerfCounters
+{
+    private:
+        int m_fd[PerfSample::EVENT_CNT];
+        long long m_iBase[PerfSample::EVENT_CNT];   //Count at start(), see start().
+        int m_iErrno;                               //First open failure, for the message.
+
+        static int open(unsigned int iType, unsigned long long iConfig, bool bUserOnly)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = iType;
+            attr.config = iConfig;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = bUserOnly ? 1 : 0;
+            attr.exclude_hv = 1;
+            return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+
+        void openEvent(PerfSample::Event e, unsigned int iType, unsigned long long iConfig, bool bAllowUserOnly)
+        {
+            m_fd[e] = open(iType, iConfig, false);
+            if (m_fd[e] < 0 && bAllowUserOnly && (EACCES == errno || EPERM == errno))
+            {
+                m_fd[e] = open(iType, iConfig, true);
+            }
+            if (m_fd[e] < 0 && 0 == m_iErrno) m_iErrno = errno;
+        }
+
+    public:
+    PerfCounters() : m_iErrno{0}
+    {
+        for (int e=0; e<PerfSample::EVENT_CNT; ++e) m_iBase[e] = 0;
+        openEvent(PerfSample::CYCLES,           PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true);
+        openEvent(PerfSample::INSTRUCTIONS,     PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true);
+        openEvent(PerfSample::LLC_MISSES,       PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true);
+        openEvent(PerfSample::BRANCH_MISSES,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, true);
+        //Switches happen in the kernel, a user only count would always read 0.
+        openEvent(PerfSample::CONTEXT_SWITCHES, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters()
+    {
+        for (int e=0; e<PerfSample::EVENT_CNT; ++e)
+        {
+            if (m_fd[e] >= 0) close(m_fd[e]);
+        }
+    }
+
+    bool anyAvailable() const
+    {
+        for (int e=0; e<PerfSample::EVENT_CNT; ++e)
+        {
+            if (m_fd[e] >= 0) return true;
+        }
+        return false;
+    }
+
+    //Empty when everything opened, else why some counters read "n/a".
+    std::string status() const
+    {
+        if (0 == m_iErrno) return "";
+        return std::string("some perf counters unavailable (") + strerror(m_iErrno) +
+               "), see /proc/sys/kernel/perf_event_paranoid";
+    }
+
+    /*
+    RESET clears only the parent's count, counts of exited inherited threads are folded in
+    separately and stay, so stop() reports the difference to the value read here.
+    */
+    void start()
+    {
+        for (int e=0; e<PerfSample::EVENT_CNT; ++e)
+        {
+            if (m_fd[e] < 0) continue;
+            ioctl(m_fd[e], PERF_EVENT_IOC_RESET, 0);
+            m_iBase[e] = 0;
+            if (read(m_fd[e], &m_iBase[e], sizeof(m_iBase[e])) != sizeof(m_iBase[e])) m_iBase[e] = 0;
+            ioctl(m_fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop(PerfSample& sample)
+    {
+        for (int e=0; e<PerfSample::EVENT_CNT; ++e)
+        {
+            sample.m_bValid[e] = false;
+            if (m_fd[e] < 0) continue;
+            ioctl(m_fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            long long iCount = 0;
+            if (read(m_fd[e], &iCount, sizeof(iCount)) == sizeof(iCount))
+            {
+                sample.m_iValue[e] = iCount - m_iBase[e];
+                sample.m_bValid[e] = true;
+            }
+        }
+    }
+};
+
+
+//Counts from construction to destruction into sample.
+class ScopedPerfCounter
+{
+    private:
+        PerfCounters& m_counters;
+        PerfSample& m_sample;
+
+    public:
+    ScopedPerfCounter(PerfCounters& counters, PerfSample& sample) : m_counters(counters), m_sample(sample)
+    {
+        m_counters.start();
+    }
+    ScopedPerfCounter(const ScopedPerfCounter&) = delete;
+    ScopedPerfCounter& operator=(const ScopedPerfCounter&) = delete;
+    ~ScopedPerfCounter() { m_counters.stop(m_sample); }
+};
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef QUEUE_TIMING_WHEEL_H
+#define QUEUE_TIMING_WHEEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/*
+Hierarchical timing wheel (Varghese & Lauck) for very many short timeouts.
+Every level is a ring of SLOTS buckets indexed like CircularQ (index wraps, SLOTS is a power
+of 2 so getNext is a mask), level L bucket covers SLOTS^L ticks. A timer goes into the lowest
+level whose range still holds its delay, when a lower level wraps the matching bucket of the
+level above is cascaded down. Delays past the top level wait in an overflow list.
+
+    schedule / cancel     O(1), bucket is an intrusive doubly linked list with a sentinel.
+    advance(now, fn)      Moves the wheel to tick now, every due bucket is spliced out whole
+                          and fn(TimerNode&) runs over the batch. Empty stretches of the wheel
+                          are skipped a whole level at a time, not tick by tick.
+    scheduleAsync         Any thread, lock-free push on an MPSC stack. The owner thread moves
+                          the stack into the wheel at the start of advance().
+
+Everything except scheduleAsync belongs to one owner thread (the one calling advance).
+TimerNodes are intrusive and owned by the caller, only an IDLE node can be scheduled, it is
+IDLE again once fired or cancelled, so fn may re-arm it (periodic timers). A node must not be
+freed while it is not IDLE.
+*/
+
+//Bucket list links, a bucket's sentinel is a bare TimerLink.
+struct TimerLink
+{
+    TimerLink *m_pPrev, *m_pNext;
+};
+
+struct TimerNode : TimerLink
+{
+    enum State : uint32_t { IDLE, PENDING, SCHEDULED, CANCELLED };
+
+    uint64_t m_iExpiry;                         //Absolute tick.
+    uint64_t m_iData;                           //For the caller, e.g. connection id.
+    int m_iLevel;                               //Wheel level while SCHEDULED, LEVELS = overflow.
+    TimerNode *m_pNextPending;                  //MPSC stack of scheduleAsync.
+    std::atomic<uint32_t> m_eState;
+
+    TimerNode() : TimerLink{NULL, NULL}, m_iExpiry{0}, m_iData{0}, m_iLevel{0}, m_pNextPending{NULL}, m_eState{IDLE} {}
+    explicit TimerNode(uint64_t iData) : TimerNode() { m_iData = iData; }
+    TimerNode(const TimerNode&) = delete;
+    TimerNode& operator=(const TimerNode&) = delete;
+
+    //False also for a cancelled node still waiting on the async stack.
+    inline bool isIdle() const { return IDLE == m_eState.load(std::memory_order_acquire); }
+};
+
+
+class TimingWheel
+{
+    public:
+    static constexpr int SLOT_BITS = 8;
+    static constexpr size_t SLOTS = (size_t)1 << SLOT_BITS;
+    static constexpr int LEVELS = 4;            //SLOTS^LEVELS = 2^32 ticks before overflow.
+
+    private:
+        static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+        typedef TimerLink Bucket;               //Sentinel, an empty bucket links to itself.
+
+        Bucket m_buckets[LEVELS][SLOTS];
+        Bucket m_overflow;
+        size_t m_iLevelCnt[LEVELS + 1];         //Timers per level, [LEVELS] = overflow.
+        size_t m_iCnt;
+        uint64_t m_iCurrent;                    //Next tick to expire.
+        alignas(64) std::atomic<TimerNode*> m_pPending;
+
+        static inline void initBucket(Bucket& b) { b.m_pPrev = b.m_pNext = &b; }
+        static inline bool isEmpty(const Bucket& b) { return b.m_pNext == &b; }
+        static inline TimerNode* first(Bucket& b) { return static_cast<TimerNode*>(b.m_pNext); }
+
+        static inline void pushBack(Bucket& b, TimerNode* pNode)
+        {
+            TimerLink* pHead = &b;
+            pNode->m_pNext = pHead;
+            pNode->m_pPrev = pHead->m_pPrev;
+            pHead->m_pPrev->m_pNext = pNode;
+            pHead->m_pPrev = pNode;
+        }
+
+        static inline void unlink(TimerNode* pNode)
+        {
+            pNode->m_pPrev->m_pNext = pNode->m_pNext;
+            pNode->m_pNext->m_pPrev = pNode->m_pPrev;
+            pNode->m_pPrev = pNode->m_pNext = NULL;
+        }
+
+        //Moves the whole bucket to the local sentinel in O(1).
+        static inline void spliceOut(Bucket& b, Bucket& out)
+        {
+            if (isEmpty(b)) { initBucket(out); return; }
+            out.m_pNext = b.m_pNext;
+            out.m_pPrev = b.m_pPrev;
+            out.m_pNext->m_pPrev = &out;
+            out.m_pPrev->m_pNext = &out;
+            initBucket(b);
+        }
+
+        //Level for the delay, LEVELS = overflow. Slot is the expiry's digit at that level.
+        inline int levelOf(uint64_t iExpiry) const
+        {
+            uint64_t iDelay = (iExpiry > m_iCurrent) ? iExpiry - m_iCurrent : 0;
+            for (int l=0; l<LEVELS; ++l)
+            {
+                if (iDelay < ((uint64_t)1 << (SLOT_BITS * (l + 1)))) return l;
+            }
+            return LEVELS;
+        }
+
+        void insert(TimerNode* pNode)
+        {
+            uint64_t iExpiry = (pNode->m_iExpiry < m_iCurrent) ? m_iCurrent : pNode->m_iExpiry;
+            int l = levelOf(iExpiry);
+            if (LEVELS == l) pushBack(m_overflow, pNode);
+            else pushBack(m_buckets[l][(iExpiry >> (SLOT_BITS * l)) & SLOT_MASK], pNode);
+            pNode->m_iLevel = l;
+            ++m_iLevelCnt[l];
+            ++m_iCnt;
+            pNode->m_eState.store(TimerNode::SCHEDULED, std::memory_order_release);
+        }
+
+        //Re-files a higher level bucket (or the overflow list) one level closer to expiry.
+        void cascade(Bucket& b, int iLevel)
+        {
+            Bucket list;
+            spliceOut(b, list);
+            while (!isEmpty(list))
+            {
+                TimerNode* pNode = first(list);
+                unlink(pNode);
+                --m_iLevelCnt[iLevel];
+                --m_iCnt;
+                insert(pNode);
+            }
+        }
+
+        void drainPending()
+        {
+            TimerNode* pStack = m_pPending.exchange(NULL, std::memory_order_acquire);
+            TimerNode* pFifo = NULL;                 //Stack is newest first, reverse it.
+            while (pStack)
+            {
+                TimerNode* pNext = pStack->m_pNextPending;
+                pStack->m_pNextPending = pFifo;
+                pFifo = pStack;
+                pStack = pNext;
+            }
+            while (pFifo)
+            {
+                TimerNode* pNext = pFifo->m_pNextPending;
+                pFifo->m_pNextPending = NULL;
+                uint32_t eState = TimerNode::PENDING;
+                if (pFifo->m_eState.compare_exchange_strong(eState, TimerNode::SCHEDULED, std::memory_order_acq_rel))
+                    insert(pFifo);
+                else
+                    pFifo->m_eState.store(TimerNode::IDLE, std::memory_order_release);   //Cancelled while pending.
+                pFifo = pNext;
+            }
+        }
+
+        //First tick >= iTick where something can happen: an expiry or a cascade.
+        inline uint64_t nextEventTick(uint64_t iTick) const
+        {
+            int l = 0;
+            while (l <= LEVELS && 0 == m_iLevelCnt[l]) ++l;
+            if (0 == l) return iTick;
+            if (l > LEVELS) return UINT64_MAX;       //Nothing scheduled.
+            uint64_t iStep = (uint64_t)1 << (SLOT_BITS * l);
+            return (iTick + iStep - 1) & ~(iStep - 1);
+        }
+
+    public:
+    explicit TimingWheel(uint64_t iStartTick = 0) : m_iCnt{0}, m_iCurrent{iStartTick}, m_pPending{NULL}
+    {
+        for (int l=0; l<LEVELS; ++l)
+        {
+            for (size_t s=0; s<SLOTS; ++s) initBucket(m_buckets[l][s]);
+        }
+        initBucket(m_overflow);
+        for (int l=0; l<=LEVELS; ++l) m_iLevelCnt[l] = 0;
+    }
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    inline size_t getCount() const { return m_iCnt; }
+    inline uint64_t getCurrent() const { return m_iCurrent; }
+
+    //Owner thread. Expiry in the past fires on the next advance.
+    bool schedule(TimerNode& node, uint64_t iExpiry)
+    {
+        if (!node.isIdle()) return false;
+        node.m_iExpiry = iExpiry;
+        insert(&node);
+        return true;
+    }
+
+    //Any thread. The node joins the wheel at the owner's next advance().
+    bool scheduleAsync(TimerNode& node, uint64_t iExpiry)
+    {
+        uint32_t eState = TimerNode::IDLE;
+        if (!node.m_eState.compare_exchange_strong(eState, TimerNode::PENDING, std::memory_order_acq_rel)) return false;
+        node.m_iExpiry = iExpiry;
+        TimerNode* pHead = m_pPending.load(std::memory_order_relaxed);
+        do
+        {
+            node.m_pNextPending = pHead;
+        } while (!m_pPending.compare_exchange_weak(pHead, &node, std::memory_order_release, std::memory_order_relaxed));
+        return true;
+    }
+
+    /*
+    Owner thread. False when the node was not scheduled (already fired or cancelled).
+    A node still on the async stack is only marked, advance() drops it and sets it IDLE,
+    until then it can't be scheduled again.
+    */
+    bool cancel(TimerNode& node)
+    {
+        uint32_t eState = TimerNode::PENDING;
+        if (node.m_eState.compare_exchange_strong(eState, TimerNode::CANCELLED, std::memory_order_acq_rel)) return true;
+        if (TimerNode::SCHEDULED != eState) return false;
+
+        --m_iLevelCnt[node.m_iLevel];
+        --m_iCnt;
+        unlink(&node);
+        node.m_eState.store(TimerNode::IDLE, std::memory_order_release);
+        return true;
+    }
+
+    /*
+    Owner thread. Expires every timer with expiry <= iNow, fn(TimerNode&) is called once per
+    timer in expiry order (same tick: schedule order). Node is IDLE inside fn, so fn may
+    schedule it again. Returns the number of timers fired.
+    */
+    template<typename Fn>
+    size_t advance(uint64_t iNow, Fn&& fn)
+    {
+        drainPending();
+        size_t iFired = 0;
+        while (m_iCurrent <= iNow)
+        {
+            uint64_t iNext = nextEventTick(m_iCurrent);
+            if (iNext > iNow) { m_iCurrent = iNow + 1; break; }
+            m_iCurrent = iNext;
+
+            //Highest wrapping level first so its timers can fall through every level below.
+            if (0 == (m_iCurrent & SLOT_MASK))
+            {
+                int iTop = 1;
+                while (iTop < LEVELS && 0 == ((m_iCurrent >> (SLOT_BITS * iTop)) & SLOT_MASK)) ++iTop;
+                if (LEVELS == iTop && m_iLevelCnt[LEVELS]) cascade(m_overflow, LEVELS);
+                for (int l = std::min(iTop, LEVELS - 1); l >= 1; --l)
+                {
+                    cascade(m_buckets[l][(m_iCurrent >> (SLOT_BITS * l)) & SLOT_MASK], l);
+                }
+            }
+
+            Bucket batch;
+            spliceOut(m_buckets[0][m_iCurrent & SLOT_MASK], batch);
+            ++m_iCurrent;
+            while (!isEmpty(batch))
+            {
+                TimerNode* pNode = first(batch);
+                unlink(pNode);
+                --m_iLevelCnt[0];
+                --m_iCnt;
+                pNode->m_eState.store(TimerNode::IDLE, std::memory_order_release);
+                fn(*pNode);
+                ++iFired;
+            }
+        }
+        return iFired;
+    }
+};
+
+#endif